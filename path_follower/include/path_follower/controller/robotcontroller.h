@@ -191,6 +191,9 @@ public:
 
     void computeMovingDirection();
 
+    //! Number of path points compared to the robot pose by the last findOrthogonalProjection call.
+    std::size_t getProjectionVisitedPoints() const;
+
 private:
     //Vizualize the path driven by the robot
     void publishPathMarker();
@@ -247,6 +250,8 @@ protected:
 
     //index of the orthogonal projection to the path
     uint proj_ind_;
+    //number of points compared in the last search for the orthogonal projection
+    std::size_t projection_visited_points_;
     //orthogonal projection
     double orth_proj_;
 
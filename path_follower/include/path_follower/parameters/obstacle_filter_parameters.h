@@ -0,0 +1,50 @@
+#ifndef OBSTACLE_FILTER_PARAMETERS_H
+#define OBSTACLE_FILTER_PARAMETERS_H
+
+#include <path_follower/parameters/path_follower_parameters.h>
+#include <path_follower/utils/parameters.h>
+#include <limits>
+
+struct ObstacleFilterParameters : public Parameters
+{
+    static const ObstacleFilterParameters* getInstance()
+    {
+        static ObstacleFilterParameters instance(PathFollowerParameters::getInstance());
+        return &instance;
+    }
+
+    P<bool> enabled;
+    P<double> voxel_size;
+    P<double> min_height;
+    P<double> max_height;
+    P<double> min_range;
+    P<double> max_range;
+    P<double> max_age;
+
+private:
+    ObstacleFilterParameters(const Parameters* parent):
+        Parameters("obstacle_filter", parent),
+
+        enabled(this, "enabled", false,
+                "Set to `true` to filter the obstacle cloud before it is used. Otherwise it is used as it is received."),
+        voxel_size(this, "voxel_size", 0.05,
+                   "Edge length of the 2D voxel grid in the fixed frame. Only one point per voxel is kept,"
+                   " so a removed point can be up to sqrt(2) * voxel_size away from the kept one:"
+                   " grow the collision polygons by at least this margin. 0 disables the downsampling."),
+        min_height(this, "height/min", -std::numeric_limits<double>::infinity(),
+                   "Points below this height (in the robot frame) are removed. -inf disables the limit."),
+        max_height(this, "height/max", std::numeric_limits<double>::infinity(),
+                   "Points above this height (in the robot frame) are removed. inf disables the limit."),
+        min_range(this, "range/min", 0.0,
+                  "Points closer to the robot are removed (e.g. returns of the robot itself)."),
+        max_range(this, "range/max", 0.0,
+                  "Points farther away from the robot are removed. 0 disables the limit."),
+        max_age(this, "max_age", 0.0,
+                "Clouds older than this (in seconds) are dropped. 0 disables the limit.")
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    {
+    }
+};
+
+#endif // OBSTACLE_FILTER_PARAMETERS_H
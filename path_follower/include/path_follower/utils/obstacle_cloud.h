@@ -1,11 +1,15 @@
 #ifndef OBSTACLE_CLOUD_H
 #define OBSTACLE_CLOUD_H
 
+#include <map>
 #include <memory>
+#include <mutex>
 #include <boost/shared_ptr.hpp>
 #include <Eigen/Core>
 #include <ros/time.h>
 
+class ObstacleGridIndex;
+
 namespace tf
 {
 class Transform;
@@ -70,6 +74,33 @@ public:
      * @return the frame id of this cloud
      */
     std::string getFrameId() const;
+
+    /**
+     * @brief getGridIndex returns a 2D grid over the points of the cloud.
+     *        It is built on first use and shared by all users of this cloud.
+     *        transformCloud and clear drop the index, other changes of <cloud> have to call invalidate().
+     */
+    std::shared_ptr<ObstacleGridIndex const> getGridIndex() const;
+
+    /**
+     * @brief getTransformed returns a copy of this cloud transformed into <target_frame>.
+     *        The copy is kept per frame and reused while <transform> does not change,
+     *        so that all users share the transformed points and their grid index.
+     */
+    std::shared_ptr<ObstacleCloud const> getTransformed(const tf::Transform& transform, const std::string& target_frame) const;
+
+    /**
+     * @brief invalidate drops all data derived from the points
+     */
+    void invalidate();
+
+private:
+    struct TransformedCopy;
+
+    mutable std::shared_ptr<ObstacleGridIndex const> grid_index_;
+
+    mutable std::mutex transformed_mutex_;
+    mutable std::map<std::string, std::shared_ptr<TransformedCopy>> transformed_;
 };
 
 #endif // OBSTACLE_CLOUD_H
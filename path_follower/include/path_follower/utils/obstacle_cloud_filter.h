@@ -0,0 +1,47 @@
+#ifndef OBSTACLE_CLOUD_FILTER_H
+#define OBSTACLE_CLOUD_FILTER_H
+
+#include <path_follower/utils/obstacle_cloud.h>
+#include <limits>
+#include <string>
+
+/**
+ * @brief The ObstacleCloudFilter class reduces sensor clouds to the points relevant for path following.
+ *
+ * Points are gated by height and range relative to the robot, transformed into the fixed frame and
+ * downsampled to one point per cell of a 2D voxel grid.
+ */
+class ObstacleCloudFilter
+{
+public:
+    struct Options
+    {
+        double voxel_size = 0.0;
+        double min_height = -std::numeric_limits<double>::infinity();
+        double max_height = std::numeric_limits<double>::infinity();
+        double min_range = 0.0;
+        double max_range = 0.0;
+    };
+
+    ObstacleCloudFilter(const Options& opt);
+
+    /**
+     * @brief usesRobotFrame is true, iff points are gated by height or range, which is measured in the robot frame
+     */
+    bool usesRobotFrame() const;
+
+    /**
+     * @brief filter removes the points outside of the height band and the range and transforms the rest into the fixed frame
+     * @param fixed_to_sensor transformation of points from the sensor frame into the fixed frame
+     * @param robot_to_sensor transformation of points from the sensor frame into the robot frame, only used if usesRobotFrame()
+     * @param fixed_frame frame of the result
+     */
+    boost::shared_ptr<ObstacleCloud::Cloud> filter(const ObstacleCloud::Cloud& sensor_cloud,
+                                                   const tf::Transform& fixed_to_sensor, const tf::Transform& robot_to_sensor,
+                                                   const std::string& fixed_frame) const;
+
+private:
+    Options opt_;
+};
+
+#endif // OBSTACLE_CLOUD_FILTER_H
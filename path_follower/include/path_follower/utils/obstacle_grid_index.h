@@ -0,0 +1,78 @@
+#ifndef OBSTACLE_GRID_INDEX_H
+#define OBSTACLE_GRID_INDEX_H
+
+#include <opencv2/core/core.hpp>
+#include <vector>
+
+/**
+ * @brief The ObstacleGridIndex class sorts the points of an obstacle cloud into a uniform 2D grid,
+ *        so that region queries only visit the points in the cells overlapping the region.
+ */
+class ObstacleGridIndex
+{
+public:
+    /**
+     * @param points 2D positions of the obstacles
+     * @param cell_size edge length of a cell, increased if the grid would have more cells than points
+     */
+    ObstacleGridIndex(const std::vector<cv::Point2f>& points, float cell_size);
+
+    std::size_t size() const;
+
+    /**
+     * @brief anyInPolygon checks, if any point lies inside of the polygon
+     */
+    bool anyInPolygon(const std::vector<cv::Point2f>& polygon) const;
+
+    /**
+     * @brief findNearest finds the point closest to pt, searching the cells in rings around pt
+     * @param max_distance only points closer than this are considered
+     * @return false, if no point is closer than max_distance
+     */
+    bool findNearest(const cv::Point2f& pt, float max_distance, cv::Point2f& nearest) const;
+
+    /**
+     * @brief forEachInBox calls fn(point) for all points in the cells overlapping the box, until fn returns true
+     * @return true, iff fn returned true
+     */
+    template <typename Callback>
+    bool forEachInBox(const cv::Rect_<float>& box, Callback fn) const
+    {
+        if(points_.empty()) {
+            return false;
+        }
+
+        int x0 = std::max(0, cellX(box.x));
+        int y0 = std::max(0, cellY(box.y));
+        int x1 = std::min(width_ - 1, cellX(box.x + box.width));
+        int y1 = std::min(height_ - 1, cellY(box.y + box.height));
+
+        for(int y = y0; y <= y1; ++y) {
+            for(int x = x0; x <= x1; ++x) {
+                std::size_t cell = y * width_ + x;
+                for(std::size_t i = offsets_[cell], end = offsets_[cell + 1]; i < end; ++i) {
+                    if(fn(points_[i])) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    int cellX(float x) const;
+    int cellY(float y) const;
+
+private:
+    float cell_size_;
+    cv::Point2f origin_;
+    int width_;
+    int height_;
+
+    // points of cell c are points_[offsets_[c] .. offsets_[c+1])
+    std::vector<std::size_t> offsets_;
+    std::vector<cv::Point2f> points_;
+};
+
+#endif // OBSTACLE_GRID_INDEX_H
@@ -9,6 +9,8 @@
 
 #include "path.h"
 #include <nav_msgs/Path.h>
+#include <cassert>
+#include <vector>
 
 class PathInterpolated {
 public:
@@ -19,29 +21,56 @@ public:
 
     void interpolatePath(const SubPath& path, const std::string& frame_id);
 
+    /**
+     * @brief The Sample struct holds all values of one point of the interpolated path.
+     *        Controllers usually read several of them for the same index, so they are stored together.
+     */
+    struct Sample
+    {
+        //curvilinear abscissa
+        double s;
+        //x and y component of the interpolated path
+        double p;
+        double q;
+        //first derivatives w.r.t. path
+        double p_prim;
+        double q_prim;
+        //second derivatives w.r.t. path
+        double p_sek;
+        double q_sek;
+        //curvature in path coordinates
+        double curvature;
+    };
+
+    //! Accessors are not bounds checked, indices are asserted in debug builds only.
+    inline const Sample& sample(const unsigned int i) const {
+        assert(i < samples_.size());
+        return samples_[i];
+    }
+
     inline double s(const unsigned int i) const {
-        return s_.at(i);
+        return sample(i).s;
     }
 
     inline double p(const unsigned int i) const {
-        return p_.at(i);
+        return sample(i).p;
     }
     inline double q(const unsigned int i) const {
-        return q_.at(i);
+        return sample(i).q;
     }
 
     inline double p_prim(const unsigned int i) const {
-        return p_prim_.at(i);
+        return sample(i).p_prim;
     }
     inline double q_prim(const unsigned int i) const {
-        return q_prim_.at(i);
+        return sample(i).q_prim;
     }
 
     inline double p_sek(const unsigned int i) const {
-        return p_sek_.at(i);
+        return sample(i).p_sek;
     }
     inline double q_sek(const unsigned int i) const {
-        return q_sek_.at(i);
+        return sample(i).q_sek;
     }
 
     inline double s_new() const {
@@ -61,8 +90,8 @@ public:
     }
 
     inline double curvature(const unsigned int i) const {
-        return curvature_.at(i);
-	}
+        return sample(i).curvature;
+    }
 
     inline std::size_t n() const {
         return N_;
@@ -72,7 +101,8 @@ public:
     double curvature_sek(const unsigned int i) const;
 
     inline double theta_p(const unsigned int i) const {
-        return atan2(q_prim_.at(i), p_prim_.at(i));
+        const Sample& c = sample(i);
+        return atan2(c.q_prim, c.p_prim);
     }
 
     inline std::string frame_id() const {
@@ -81,12 +111,12 @@ public:
 
     inline void get_end(Waypoint &wp)
     {
-        const unsigned int i = p_.size()-1;
+        const Sample& c = samples_.back();
 
-        wp.x = p_[i];
-        wp.y = q_[i];
-        wp.orientation = std::atan2(q_prim_[i],p_prim_[i]);
-        wp.s = s_[i];
+        wp.x = c.p;
+        wp.y = c.q;
+        wp.orientation = std::atan2(c.q_prim, c.p_prim);
+        wp.s = c.s;
 
     }
 
@@ -100,7 +130,7 @@ public:
 private:
 	void clearBuffers();
 
-    void interpolatePath(const std::deque<Waypoint>& waypoints);
+    void interpolatePath(const std::vector<Waypoint>& waypoints);
 
     //number of path elements
     uint N_;
@@ -108,22 +138,16 @@ private:
     Path::Ptr original_path_;
 
 	nav_msgs::Path interp_path;
-    //curvilinear abscissa
-    std::vector<double> s_;
-    //x component of the interpolated path
-	std::vector<double> p_;
-    //y componenet of the interpolated path
-    std::vector<double> q_;
-    //first derivative of the x component w.r.t. path
-    std::vector<double> p_prim_;
-    //first derivative of the y component w.r.t. path
-    std::vector<double> q_prim_;
-    //second derivative of the x component w.r.t. path
-    std::vector<double> p_sek_;
-    //second derivative of the y component w.r.t. path
-    std::vector<double> q_sek_;
-    //curvature in path coordinates
-	std::vector<double> curvature_;
+
+    //interpolated points, the capacity is kept when a new path is interpolated
+    std::vector<Sample> samples_;
+
+    //scratch buffers of the interpolation, kept to avoid reallocations
+    std::vector<Waypoint> waypoints_;
+    std::vector<double> x_buf_;
+    std::vector<double> y_buf_;
+    std::vector<double> l_buf_;
+    std::vector<double> l_unif_buf_;
 
     //next point
     double s_new_;
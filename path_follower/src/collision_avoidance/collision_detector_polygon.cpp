@@ -1,5 +1,6 @@
 #include <path_follower/collision_avoidance/collision_detector_polygon.h>
 #include <path_follower/utils/obstacle_cloud.h>
+#include <path_follower/utils/obstacle_grid_index.h>
 
 #define DEBUG_PATHLOOKOUT 0
 
@@ -34,16 +35,15 @@ bool CollisionDetectorPolygon::checkOnCloud(std::shared_ptr<ObstacleCloud const>
     if(obstacles->header.frame_id != pwf.frame) {
         /// transform the polygon to the obstacle cloud frame
         try {
-            geometry_msgs::PointStamped gm_p, gm_pt;
-            gm_p.header.frame_id = pwf.frame;
-            gm_p.header.stamp = pcl_conversions::fromPCL(obstacles->header.stamp);
-    
+            // one lookup for all corners
+            tf::StampedTransform transform;
+            ros::Time stamp = pcl_conversions::fromPCL(obstacles->header.stamp);
+            tf_listener_->lookupTransform(obstacles->header.frame_id, pwf.frame, stamp, transform);
+
             for (cv::Point2f &p : pwf.polygon) {
-                gm_p.point.x = p.x;
-                gm_p.point.y = p.y;
-                tf_listener_->transformPoint(obstacles->header.frame_id, gm_p, gm_pt);
-                p.x = gm_pt.point.x;
-                p.y = gm_pt.point.y;
+                tf::Point pt = transform * tf::Point(p.x, p.y, 0.0);
+                p.x = pt.x();
+                p.y = pt.y();
             }
             pwf.frame = obstacles->header.frame_id;
 
@@ -54,16 +54,8 @@ bool CollisionDetectorPolygon::checkOnCloud(std::shared_ptr<ObstacleCloud const>
         }
     }
 
-    /// now check each point of the scan
-    for (auto point_it = obstacles->begin(); point_it != obstacles->end(); ++point_it) {
-        // check if this scan point is inside the polygon
-        cv::Point2f point( point_it->x, point_it->y );
-
-        if (cv::pointPolygonTest(pwf.polygon, point, false) > 0.5) {
-            collision = true;
-            break; // no need to check the remaining points
-        }
-    }
+    /// only the points in the bounding box of the polygon are checked
+    collision = obstacles_container->getGridIndex()->anyInPolygon(pwf.polygon);
 
 
     // visualization
@@ -21,6 +21,7 @@ RobotController::RobotController()
       dir_sign_(1.0f),
       interpolated_(false),
       proj_ind_(0),
+      projection_visited_points_(0),
       k_curv_(0.0),
       k_o_(0.0),
       k_g_(0.0),
@@ -213,44 +214,88 @@ void RobotController::findOrthogonalProjection()
     //find the orthogonal projection to the curve and extract the corresponding index
 
     orth_proj_ = std::numeric_limits<double>::max();
+    projection_visited_points_ = 0;
 
     Eigen::Vector3d current_pose = pose_tracker_->getRobotPose();
     double x_meas = current_pose[0];
     double y_meas = current_pose[1];
 
-    double dist = 0;
-    double dx = 0.0;
-    double dy = 0.0;
-    //this is a trick for closed paths, if the start and goal point are very close
-    //without this, the robot would reach the goal, without even driving
-    int old_ind = proj_ind_;
-
-    for (unsigned int i = proj_ind_, n = path_interpol.n(); i < n; i++){
+    const unsigned int n = path_interpol.n();
+    if(n == 0) {
+        return;
+    }
 
-        dist = hypot(x_meas - path_interpol.p(i), y_meas - path_interpol.q(i));
-        if((dist < orth_proj_) && (i - old_ind <= 3)){
+    auto distance = [&](unsigned int i) {
+        ++projection_visited_points_;
+        return hypot(x_meas - path_interpol.p(i), y_meas - path_interpol.q(i));
+    };
 
+    //this is a trick for closed paths, if the start and goal point are very close
+    //without this, the robot would reach the goal, without even driving:
+    //the projection only moves a few points ahead of the last one per call
+    const unsigned int window = 3;
+    unsigned int window_end = std::min(proj_ind_ + window, n - 1);
+    for (unsigned int i = proj_ind_; i <= window_end; i++){
+        double dist = distance(i);
+        if(dist < orth_proj_){
             orth_proj_ = dist;
             proj_ind_ = i;
-
-            dx = x_meas - path_interpol.p(proj_ind_);
-            dy = y_meas - path_interpol.q(proj_ind_);
         }
+    }
 
-        // debuging information
-        if(i == n - 1) {
-            if(proj_ind_ != i) {
-                ROS_DEBUG_STREAM("projection: dist:" << dist
-                                 << ", orth_proj: " << orth_proj_
-                                 << ", old_ind: " << old_ind);
+    //the robot left the window, follow the path as long as it gets closer
+    if(proj_ind_ == window_end) {
+        for (unsigned int i = window_end + 1; i < n; i++){
+            double dist = distance(i);
+            if(dist >= orth_proj_){
+                break;
             }
+            orth_proj_ = dist;
+            proj_ind_ = i;
+        }
+        if(proj_ind_ > window_end) {
+            ROS_DEBUG_STREAM("projection: left the window, moved from " << window_end << " to " << proj_ind_);
         }
     }
 
+    //refine the projection between the neighboring points with Newton's method on
+    //the local expansion c(ds) = c + c' ds + c'' ds^2 / 2 of the spline
+    const PathInterpolated::Sample& c = path_interpol.sample(proj_ind_);
+    double ds_min = proj_ind_ > 0 ? path_interpol.s(proj_ind_ - 1) - c.s : 0.0;
+    double ds_max = proj_ind_ + 1 < n ? path_interpol.s(proj_ind_ + 1) - c.s : 0.0;
+    double ds = 0.0;
+    for(int iteration = 0; iteration < 3; ++iteration) {
+        double ex = c.p + c.p_prim * ds + 0.5 * c.p_sek * ds * ds - x_meas;
+        double ey = c.q + c.q_prim * ds + 0.5 * c.q_sek * ds * ds - y_meas;
+        double tx = c.p_prim + c.p_sek * ds;
+        double ty = c.q_prim + c.q_sek * ds;
+
+        double gradient = ex * tx + ey * ty;
+        double hessian = tx * tx + ty * ty + ex * c.p_sek + ey * c.q_sek;
+        if(hessian <= 0.0) {
+            break;
+        }
+        ds = std::max(ds_min, std::min(ds_max, ds - gradient / hessian));
+    }
+
+    double px = c.p + c.p_prim * ds + 0.5 * c.p_sek * ds * ds;
+    double py = c.q + c.q_prim * ds + 0.5 * c.q_sek * ds * ds;
+    double refined = hypot(x_meas - px, y_meas - py);
+
+    double dx = x_meas - c.p;
+    double dy = y_meas - c.q;
+    double path_angle = std::atan2(c.q_prim, c.p_prim);
+    if(refined < orth_proj_) {
+        orth_proj_ = refined;
+        dx = x_meas - px;
+        dy = y_meas - py;
+        path_angle = std::atan2(c.q_prim + c.q_sek * ds, c.p_prim + c.p_sek * ds);
+    }
+
     //determine the sign of the orthogonal distance
     Eigen::Vector2d path2vehicle_vec(dx, dy);
     double path2vehicle_angle = MathHelper::Angle(path2vehicle_vec);
-    double theta_diff = MathHelper::AngleDelta(path_interpol.theta_p(proj_ind_), path2vehicle_angle);
+    double theta_diff = MathHelper::AngleDelta(path_angle, path2vehicle_angle);
 
     if( theta_diff < 0 && theta_diff >= -M_PI){
 
@@ -262,6 +307,11 @@ void RobotController::findOrthogonalProjection()
     //***//
 }
 
+std::size_t RobotController::getProjectionVisitedPoints() const
+{
+    return projection_visited_points_;
+}
+
 
 bool RobotController::isGoalReached(MoveCommand *cmd)
 {
@@ -7,6 +7,7 @@
 // PROJECT
 #include <path_follower/utils/pose_tracker.h>
 #include <path_follower/utils/obstacle_cloud.h>
+#include <path_follower/utils/obstacle_grid_index.h>
 #include <path_follower/parameters/path_follower_parameters.h>
 #include <path_follower/collision_avoidance/collision_avoider.h>
 #include <cslibs_navigation_utilities/MathHelper.h>
@@ -139,29 +140,24 @@ void RobotController_Dynamic_Window::searchMinObstDist(){
     obst_dist_marker.action = visualization_msgs::Marker::ADD;
 
     auto obstacle_cloud = collision_avoider_->getObstacles();
-    const pcl::PointCloud<pcl::PointXYZ>& cloud = *obstacle_cloud->cloud;
+    const std::string& frame = obstacle_cloud->cloud->header.frame_id;
+
+    // the predicted position is moved into the cloud frame instead of transforming all points into the fixed frame
+    tf::Transform trafo = tf::Transform::getIdentity();
+    if(frame != pose_tracker_->getFixedFrameId()) {
+        trafo = pose_tracker_->getTransform(pose_tracker_->getFixedFrameId(), frame, ros::Time(0), ros::Duration(0));
+    }
+    tf::Point pred = trafo.inverse() * tf::Point(x_pred_, y_pred_, 0.0);
+
     double min_dist = std::numeric_limits<double>::infinity();
     tf::Point coll_pt(0.0, 0.0, 0.0);
-    if(cloud.header.frame_id == pose_tracker_->getFixedFrameId()) {
-        for(const pcl::PointXYZ& pt : cloud) {
-            if(std::hypot(pt.x - x_pred_, pt.y - y_pred_) < min_dist){
-                min_dist = std::hypot(pt.x - x_pred_, pt.y - y_pred_);
-                coll_pt.setX(pt.x);
-                coll_pt.setY(pt.y);
-            }
-        }
-
-    } else {
-        tf::Transform trafo = pose_tracker_->getTransform(pose_tracker_->getFixedFrameId(), cloud.header.frame_id, ros::Time(0), ros::Duration(0));
-        for(const pcl::PointXYZ& pt : cloud) {
-            tf::Point pt_cloud(pt.x, pt.y, pt.z);
-            tf::Point pt_ff = trafo * pt_cloud;
-            if(std::hypot(pt_ff.getX() - x_pred_, pt_ff.getY() - y_pred_)){
-                min_dist = std::hypot(pt_ff.getX() - x_pred_, pt_ff.getY() - y_pred_);
-                coll_pt.setX(pt_ff.getX());
-                coll_pt.setY(pt_ff.getY());
-            }
-        }
+    cv::Point2f nearest;
+    if(obstacle_cloud->getGridIndex()->findNearest(cv::Point2f(pred.x(), pred.y()),
+                                                   std::numeric_limits<float>::infinity(), nearest)) {
+        tf::Point pt_ff = trafo * tf::Point(nearest.x, nearest.y, pred.z());
+        min_dist = std::hypot(pt_ff.getX() - x_pred_, pt_ff.getY() - y_pred_);
+        coll_pt.setX(pt_ff.getX());
+        coll_pt.setY(pt_ff.getY());
     }
 
 
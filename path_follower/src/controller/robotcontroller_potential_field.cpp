@@ -7,6 +7,7 @@
 // PROJECT
 #include <path_follower/utils/pose_tracker.h>
 #include <path_follower/utils/obstacle_cloud.h>
+#include <path_follower/utils/obstacle_grid_index.h>
 #include <path_follower/parameters/path_follower_parameters.h>
 #include <path_follower/collision_avoidance/collision_avoider.h>
 #include <cslibs_navigation_utilities/MathHelper.h>
@@ -255,33 +256,24 @@ void RobotController_Potential_Field::computeFReps()
 void RobotController_Potential_Field::findObstacles()
 {
     double obst_angle = 0.0;
-    auto obstacle_cloud = collision_avoider_->getObstacles();
-    const pcl::PointCloud<pcl::PointXYZ>& cloud = *obstacle_cloud->cloud;
-    pcl::PointCloud<pcl::PointXYZ> obst_points_new;
     double min_dist = std::numeric_limits<double>::infinity();
-    if(cloud.header.frame_id == "base_link" || cloud.header.frame_id == "/base_link") {
-
-        for(const pcl::PointXYZ& pt : cloud) {
-
-            if(std::sqrt(pt.x*pt.x + pt.y*pt.y + pt.z*pt.z) < min_dist){
-
-                obst_angle = std::atan2(pt.y, pt.x);
-            }
-            min_dist = std::min<double>(min_dist, std::sqrt(pt.x*pt.x + pt.y*pt.y + pt.z*pt.z));
-        }
 
-    } else {
-        tf::Transform trafo = pose_tracker_->getTransform(pose_tracker_->getRobotFrameId(), cloud.header.frame_id, ros::Time(0), ros::Duration(0));
-        for(const pcl::PointXYZ& pt : cloud) {
-            tf::Point pt_cloud(pt.x, pt.y, pt.z);
-            tf::Point pt_robot = trafo * pt_cloud;
-
-            if(pt_robot.length() < min_dist){
-                obst_angle = std::atan2(pt_robot.getY(), pt_robot.getX());
-            }
+    auto obstacle_cloud = collision_avoider_->getObstacles();
+    const std::string& frame = obstacle_cloud->cloud->header.frame_id;
 
-            min_dist = std::min<double>(min_dist, pt_robot.length());
-        }
+    // the robot is moved into the cloud frame instead of transforming all points into the robot frame
+    tf::Transform trafo = tf::Transform::getIdentity();
+    if(frame != "base_link" && frame != "/base_link") {
+        trafo = pose_tracker_->getTransform(pose_tracker_->getRobotFrameId(), frame, ros::Time(0), ros::Duration(0));
+    }
+    tf::Point robot = trafo.inverse() * tf::Point(0.0, 0.0, 0.0);
+
+    cv::Point2f nearest;
+    if(obstacle_cloud->getGridIndex()->findNearest(cv::Point2f(robot.x(), robot.y()),
+                                                   std::numeric_limits<float>::infinity(), nearest)) {
+        tf::Point pt_robot = trafo * tf::Point(nearest.x, nearest.y, robot.z());
+        min_dist = std::hypot(pt_robot.getX(), pt_robot.getY());
+        obst_angle = std::atan2(pt_robot.getY(), pt_robot.getX());
     }
 
     obstacles[0] = min_dist;
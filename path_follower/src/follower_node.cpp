@@ -3,21 +3,50 @@
 #include <path_follower/path_follower_server.h>
 #include <path_follower/utils/parameters.h>
 #include <path_follower/utils/obstacle_cloud.h>
+#include <path_follower/utils/obstacle_cloud_filter.h>
+#include <path_follower/parameters/obstacle_filter_parameters.h>
 #include <path_follower/utils/elevation_map.h>
 #include <path_follower/utils/pose_tracker.h>
 #include <path_follower/factory/follower_factory.h>
 #include <pcl_ros/point_cloud.h>
 #include <sensor_msgs/Image.h>
 #include <std_msgs/Int8.h>
+#include <std_msgs/UInt32MultiArray.h>
 #include <tf/tf.h>
 #include <fstream>
 
 namespace {
-void importCloud(const ObstacleCloud::Cloud::ConstPtr& sensor_cloud, PathFollower* pf)
+struct ObstacleImport
+{
+    std::unique_ptr<ObstacleCloudFilter> filter;
+    ros::Publisher statistics_pub;
+    uint32_t dropped = 0;
+
+    void publishStatistics(uint32_t points_in, uint32_t points_out)
+    {
+        std_msgs::UInt32MultiArray msg;
+        msg.layout.dim.resize(1);
+        msg.layout.dim[0].label = "points_in, points_out, dropped_clouds";
+        msg.layout.dim[0].size = 3;
+        msg.layout.dim[0].stride = 3;
+        msg.data = { points_in, points_out, dropped };
+        statistics_pub.publish(msg);
+    }
+};
+
+void importCloud(const ObstacleCloud::Cloud::ConstPtr& sensor_cloud, PathFollower* pf, ObstacleImport* import)
 {
     ros::Time now;
     now.fromNSec(sensor_cloud->header.stamp * 1e3);
 
+    const ObstacleFilterParameters& opt = *ObstacleFilterParameters::getInstance();
+    if(opt.max_age() > 0.0 && ros::Time::now() - now > ros::Duration(opt.max_age())) {
+        ++import->dropped;
+        import->publishStatistics(sensor_cloud->size(), 0);
+        ROS_WARN_STREAM_THROTTLE(1, "dropping obstacle cloud, it is " << (ros::Time::now() - now).toSec() << "s old");
+        return;
+    }
+
     std::string sensor_frame = sensor_cloud->header.frame_id;
     if(sensor_frame.at(0) == '/') {
         sensor_frame = sensor_frame.substr(1);
@@ -28,8 +57,21 @@ void importCloud(const ObstacleCloud::Cloud::ConstPtr& sensor_cloud, PathFollowe
     try {
         tf::Transform fixed_to_sensor = pose_tracker.getTransform(pose_tracker.getFixedFrameId(), sensor_frame, now, ros::Duration(0.1));
 
-        auto obstacle_cloud = std::make_shared<ObstacleCloud>(sensor_cloud);
-        obstacle_cloud->transformCloud(fixed_to_sensor, pose_tracker.getFixedFrameId());
+        std::shared_ptr<ObstacleCloud> obstacle_cloud;
+        if(import->filter) {
+            // without height or range gating, the robot frame does not have to be known at the time of the cloud
+            tf::Transform robot_to_sensor = tf::Transform::getIdentity();
+            if(import->filter->usesRobotFrame()) {
+                robot_to_sensor = pose_tracker.getTransform(pose_tracker.getRobotFrameId(), sensor_frame, now, ros::Duration(0.1));
+            }
+            obstacle_cloud = std::make_shared<ObstacleCloud>(
+                        import->filter->filter(*sensor_cloud, fixed_to_sensor, robot_to_sensor, pose_tracker.getFixedFrameId()));
+        } else {
+            obstacle_cloud = std::make_shared<ObstacleCloud>(sensor_cloud);
+            obstacle_cloud->transformCloud(fixed_to_sensor, pose_tracker.getFixedFrameId());
+        }
+
+        import->publishStatistics(sensor_cloud->size(), obstacle_cloud->cloud->size());
         pf->setObstacles(obstacle_cloud);
     } catch(const std::exception& e) {
         ROS_ERROR_STREAM_THROTTLE(1, "error transforming the obstacle cloud from " <<
@@ -140,9 +182,23 @@ int main(int argc, char** argv) {
     }
 
 
+    ObstacleImport obstacle_import;
+    const ObstacleFilterParameters& filter_opt = *ObstacleFilterParameters::getInstance();
+    if(filter_opt.enabled()) {
+        ObstacleCloudFilter::Options options;
+        options.voxel_size = filter_opt.voxel_size();
+        options.min_height = filter_opt.min_height();
+        options.max_height = filter_opt.max_height();
+        options.min_range = filter_opt.min_range();
+        options.max_range = filter_opt.max_range();
+        obstacle_import.filter.reset(new ObstacleCloudFilter(options));
+    }
+    obstacle_import.statistics_pub = ros::NodeHandle("~").advertise<std_msgs::UInt32MultiArray>("obstacle_filter/statistics", 1);
+
+    // with the filter, only the latest cloud is of interest, older ones are dropped instead of being processed late
     ros::Subscriber obstacle_cloud_sub_ =
-            nh.subscribe<ObstacleCloud::Cloud>("obstacle_cloud", 10,
-                                        boost::bind(&importCloud, _1, &pf));
+            nh.subscribe<ObstacleCloud::Cloud>("obstacle_cloud", filter_opt.enabled() ? 1 : 10,
+                                        boost::bind(&importCloud, _1, &pf, &obstacle_import));
     ros::Subscriber elevation_map_sub_ =
                 nh.subscribe<ElevationMap::EMapType>("elevation_map", 1,
                                             boost::bind(&importElevationMap, _1, &pf));
@@ -5,6 +5,7 @@
 #include <path_follower/parameters/local_planner_parameters.h>
 #include <path_follower/parameters/path_follower_parameters.h>
 #include <path_follower/utils/obstacle_cloud.h>
+#include <path_follower/utils/obstacle_grid_index.h>
 #include <pcl_ros/point_cloud.h>
 #include <path_follower/utils/pose_tracker.h>
 
@@ -200,17 +201,12 @@ void LocalPlannerClassic::setDistances(LNode& current){
 }
 
 void LocalPlannerClassic::findClosestObstaclePoint(std::shared_ptr<ObstacleCloud const>& cloud_container, tf::Point& pt, double& closest_obst, double& closest_x, double& closest_y, bool& change){
-    const auto& cloud = cloud_container->cloud;
-    for (auto point_it = cloud->begin(); point_it != cloud->end(); ++point_it){
-        double x = (double)(point_it->x) - pt.x();
-        double y = (double)(point_it->y) - pt.y();
-        double dist = std::hypot(x, y);
-        if(dist < closest_obst) {
-            change = true;
-            closest_obst = dist;
-            closest_x = (double)(point_it->x);
-            closest_y = (double)(point_it->y);
-        }
+    cv::Point2f nearest;
+    if(cloud_container->getGridIndex()->findNearest(cv::Point2f(pt.x(), pt.y()), closest_obst, nearest)){
+        change = true;
+        closest_obst = std::hypot((double)(nearest.x) - pt.x(), (double)(nearest.y) - pt.y());
+        closest_x = (double)(nearest.x);
+        closest_y = (double)(nearest.y);
     }
 }
 
@@ -234,7 +234,6 @@ std::list<cv::Point2f> PathLookout::findObstaclesInCloud(const std::shared_ptr<O
     ObstacleCloud::Cloud::ConstPtr cloud = obstacles_container->cloud;
 
     //TODO: ensure that obstacle_frame_ is the frame of the path.
-    ObstacleCloud::Cloud trans_cloud;
     bool has_tf = pose_tracker_.getTransformListener().waitForTransform(obstacle_frame_,
                                                                         cloud->header.frame_id,
                                                                         pcl_conversions::fromPCL(cloud->header.stamp),
@@ -244,11 +243,19 @@ std::list<cv::Point2f> PathLookout::findObstaclesInCloud(const std::shared_ptr<O
                         cloud->header.frame_id.c_str());
         return std::list<cv::Point2f>(); // return empty cloud
     }
-    if (!pcl_ros::transformPointCloud(obstacle_frame_, *cloud, trans_cloud, pose_tracker_.getTransformListener())) {
-        ROS_ERROR_THROTTLE_NAMED(1.0, MODULE, "Failed to transform obstacle cloud");
+    tf::StampedTransform transform;
+    try {
+        pose_tracker_.getTransformListener().lookupTransform(obstacle_frame_, cloud->header.frame_id,
+                                                             pcl_conversions::fromPCL(cloud->header.stamp), transform);
+    } catch (const tf::TransformException& ex) {
+        ROS_ERROR_THROTTLE_NAMED(1.0, MODULE, "Failed to transform obstacle cloud: %s", ex.what());
         return std::list<cv::Point2f>(); // return empty cloud
     }
 
+    // the transformed copy is shared with the other users of the cloud
+    std::shared_ptr<ObstacleCloud const> trans_obstacles = obstacles_container->getTransformed(transform, obstacle_frame_);
+    const ObstacleCloud::Cloud& trans_cloud = *trans_obstacles->cloud;
+
     //! Contains an 'is obstacle' flag for each point in the cloud
     vector<bool> is_point_obs(trans_cloud.size(), false);
 
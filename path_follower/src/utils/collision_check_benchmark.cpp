@@ -0,0 +1,124 @@
+/*
+ * Benchmark for the polygon test of CollisionDetectorPolygon::checkOnCloud.
+ * Compares testing every point of the cloud against testing the points of the grid index.
+ *
+ * Usage: collision_check_benchmark [cloud.pcd ...]
+ * Without arguments, a random cloud with 50000 points is used.
+ */
+
+/// PROJECT
+#include <path_follower/utils/obstacle_cloud.h>
+#include <path_follower/utils/obstacle_grid_index.h>
+
+/// THIRD PARTY
+#include <opencv2/imgproc/imgproc.hpp>
+#include <pcl/io/pcd_io.h>
+#include <pcl_ros/point_cloud.h>
+
+/// SYSTEM
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+typedef std::chrono::high_resolution_clock Clock;
+
+double msSince(const Clock::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+ObstacleCloud::Cloud::Ptr randomCloud(std::size_t n)
+{
+    ObstacleCloud::Cloud::Ptr cloud(new ObstacleCloud::Cloud);
+    for(std::size_t i = 0; i < n; ++i) {
+        // most points far away, like the returns of a 3D lidar
+        double r = 1.0 + 29.0 * std::sqrt(std::rand() / (double) RAND_MAX);
+        double phi = 2 * M_PI * (std::rand() / (double) RAND_MAX);
+        cloud->points.emplace_back(r * std::cos(phi), r * std::sin(phi), 0.0);
+    }
+    return cloud;
+}
+
+std::vector<cv::Point2f> box(float length, float width, float angle)
+{
+    std::vector<cv::Point2f> polygon;
+    float c = std::cos(angle), s = std::sin(angle);
+    for(cv::Point2f pt : { cv::Point2f(0, -width / 2), cv::Point2f(length, -width / 2),
+                           cv::Point2f(length, width / 2), cv::Point2f(0, width / 2) }) {
+        polygon.emplace_back(c * pt.x - s * pt.y, s * pt.x + c * pt.y);
+    }
+    return polygon;
+}
+
+bool linearTest(const ObstacleCloud::Cloud& cloud, const std::vector<cv::Point2f>& polygon)
+{
+    for(const auto& pt : cloud.points) {
+        if(cv::pointPolygonTest(polygon, cv::Point2f(pt.x, pt.y), false) > 0.5) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<ObstacleCloud::Cloud::Ptr> clouds;
+    for(int i = 1; i < argc; ++i) {
+        ObstacleCloud::Cloud::Ptr cloud(new ObstacleCloud::Cloud);
+        if(pcl::io::loadPCDFile(argv[i], *cloud) != 0) {
+            std::cerr << "cannot read " << argv[i] << std::endl;
+            return 1;
+        }
+        clouds.push_back(cloud);
+    }
+    if(clouds.empty()) {
+        clouds.push_back(randomCloud(50000));
+    }
+
+    // collision boxes of different lengths in all directions, most of them free
+    std::vector<std::vector<cv::Point2f>> polygons;
+    for(int i = 0; i < 64; ++i) {
+        polygons.push_back(box(0.5f + (i % 8) * 0.25f, 0.6f, i * 2 * M_PI / 64));
+    }
+
+    for(const ObstacleCloud::Cloud::Ptr& cloud : clouds) {
+        std::size_t hits = 0;
+        bool equal = true;
+
+        Clock::time_point start = Clock::now();
+        std::vector<bool> expected;
+        for(const auto& polygon : polygons) {
+            expected.push_back(linearTest(*cloud, polygon));
+        }
+        double t_linear = msSince(start) / polygons.size();
+
+        ObstacleCloud obstacles(cloud);
+        start = Clock::now();
+        auto index = obstacles.getGridIndex();
+        double t_build = msSince(start);
+
+        start = Clock::now();
+        for(std::size_t i = 0; i < polygons.size(); ++i) {
+            bool collision = index->anyInPolygon(polygons[i]);
+            hits += collision;
+            equal &= collision == expected[i];
+        }
+        double t_index = msSince(start) / polygons.size();
+
+        std::cout << cloud->size() << " points, " << hits << " / " << polygons.size() << " polygons in collision\n"
+                  << "  linear: " << t_linear << "ms per check\n"
+                  << "  index:  " << t_index << "ms per check, built once in " << t_build << "ms"
+                  << (equal ? "" : " (MISMATCH)") << std::endl;
+
+        if(!equal) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -1,8 +1,16 @@
 /// HEADER
 #include <path_follower/utils/obstacle_cloud.h>
+#include <path_follower/utils/obstacle_grid_index.h>
 
 #include <pcl_ros/point_cloud.h>
 #include <tf/tf.h>
+#include <cmath>
+
+struct ObstacleCloud::TransformedCopy
+{
+    tf::Transform transform;
+    std::shared_ptr<ObstacleCloud const> cloud;
+};
 
 ObstacleCloud::ObstacleCloud()
     : cloud(new Cloud)
@@ -24,6 +32,7 @@ bool ObstacleCloud::empty() const
 
 void ObstacleCloud::clear()
 {
+    invalidate();
     return cloud->clear();
 }
 
@@ -38,6 +47,8 @@ void ObstacleCloud::transformCloud(const tf::Transform& transform, const std::st
     }
 
     cloud->header.frame_id = target_frame;
+
+    invalidate();
 }
 
 ros::Time ObstacleCloud::getStamp() const
@@ -51,3 +62,46 @@ std::string ObstacleCloud::getFrameId() const
 {
     return cloud->header.frame_id;
 }
+
+std::shared_ptr<ObstacleGridIndex const> ObstacleCloud::getGridIndex() const
+{
+    // the index is immutable once built, concurrent first calls may build it twice
+    std::shared_ptr<ObstacleGridIndex const> index = std::atomic_load(&grid_index_);
+    if(!index) {
+        std::vector<cv::Point2f> points;
+        points.reserve(cloud->size());
+        for(const ObstaclePoint& pt : cloud->points) {
+            if(std::isfinite(pt.x) && std::isfinite(pt.y)) {
+                points.emplace_back(pt.x, pt.y);
+            }
+        }
+
+        const float cell_size = 0.2f;
+        index = std::make_shared<ObstacleGridIndex>(points, cell_size);
+        std::atomic_store(&grid_index_, index);
+    }
+    return index;
+}
+
+std::shared_ptr<ObstacleCloud const> ObstacleCloud::getTransformed(const tf::Transform& transform, const std::string& target_frame) const
+{
+    std::unique_lock<std::mutex> lock(transformed_mutex_);
+    std::shared_ptr<TransformedCopy>& copy = transformed_[target_frame];
+    if(!copy || !(copy->transform == transform)) {
+        auto cloud_copy = std::make_shared<ObstacleCloud>(boost::shared_ptr<Cloud const>(cloud));
+        cloud_copy->transformCloud(transform, target_frame);
+
+        copy = std::make_shared<TransformedCopy>();
+        copy->transform = transform;
+        copy->cloud = cloud_copy;
+    }
+    return copy->cloud;
+}
+
+void ObstacleCloud::invalidate()
+{
+    std::atomic_store(&grid_index_, std::shared_ptr<ObstacleGridIndex const>());
+
+    std::unique_lock<std::mutex> lock(transformed_mutex_);
+    transformed_.clear();
+}
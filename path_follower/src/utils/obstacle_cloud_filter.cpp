@@ -0,0 +1,77 @@
+/// HEADER
+#include <path_follower/utils/obstacle_cloud_filter.h>
+
+#include <pcl_ros/point_cloud.h>
+#include <tf/tf.h>
+#include <cmath>
+#include <unordered_set>
+
+ObstacleCloudFilter::ObstacleCloudFilter(const Options& opt)
+    : opt_(opt)
+{
+}
+
+bool ObstacleCloudFilter::usesRobotFrame() const
+{
+    return std::isfinite(opt_.min_height) || std::isfinite(opt_.max_height) || opt_.min_range > 0.0 || opt_.max_range > 0.0;
+}
+
+boost::shared_ptr<ObstacleCloud::Cloud> ObstacleCloudFilter::filter(const ObstacleCloud::Cloud& sensor_cloud,
+                                                                    const tf::Transform& fixed_to_sensor, const tf::Transform& robot_to_sensor,
+                                                                    const std::string& fixed_frame) const
+{
+    ObstacleCloud::Cloud::Ptr result(new ObstacleCloud::Cloud);
+    result->header = sensor_cloud.header;
+    result->header.frame_id = fixed_frame;
+    result->points.reserve(sensor_cloud.size());
+
+    const bool gate_height = std::isfinite(opt_.min_height) || std::isfinite(opt_.max_height);
+    const bool gate_range = opt_.min_range > 0.0 || opt_.max_range > 0.0;
+    const double max_range = opt_.max_range > 0.0 ? opt_.max_range : std::numeric_limits<double>::infinity();
+
+    // the voxel grid lives in the fixed frame, so that the kept points do not change while the robot moves
+    std::unordered_set<uint64_t> occupied_voxels;
+    if(opt_.voxel_size > 0.0) {
+        occupied_voxels.reserve(sensor_cloud.size());
+    }
+
+    for(const ObstacleCloud::ObstaclePoint& pt : sensor_cloud.points) {
+        if(!std::isfinite(pt.x) || !std::isfinite(pt.y) || !std::isfinite(pt.z)) {
+            continue;
+        }
+
+        tf::Point sensor_point(pt.x, pt.y, pt.z);
+
+        if(gate_height || gate_range) {
+            tf::Point robot_point = robot_to_sensor * sensor_point;
+            if(robot_point.z() < opt_.min_height || robot_point.z() > opt_.max_height) {
+                continue;
+            }
+            if(gate_range) {
+                double range = std::hypot(robot_point.x(), robot_point.y());
+                if(range < opt_.min_range || range > max_range) {
+                    continue;
+                }
+            }
+        }
+
+        tf::Point fixed_point = fixed_to_sensor * sensor_point;
+        if(opt_.voxel_size > 0.0) {
+            // keep the first point of each voxel, it is an actual measurement unlike the voxel center or centroid
+            int32_t vx = static_cast<int32_t>(std::floor(fixed_point.x() / opt_.voxel_size));
+            int32_t vy = static_cast<int32_t>(std::floor(fixed_point.y() / opt_.voxel_size));
+            uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(vx)) << 32) | static_cast<uint32_t>(vy);
+            if(!occupied_voxels.insert(key).second) {
+                continue;
+            }
+        }
+
+        result->points.emplace_back(fixed_point.x(), fixed_point.y(), fixed_point.z());
+    }
+
+    result->width = result->points.size();
+    result->height = 1;
+    result->is_dense = true;
+
+    return result;
+}
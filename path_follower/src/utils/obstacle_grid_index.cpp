@@ -0,0 +1,142 @@
+/// HEADER
+#include <path_follower/utils/obstacle_grid_index.h>
+
+/// THIRD PARTY
+#include <opencv2/imgproc/imgproc.hpp>
+
+/// SYSTEM
+#include <algorithm>
+#include <cmath>
+
+ObstacleGridIndex::ObstacleGridIndex(const std::vector<cv::Point2f>& points, float cell_size)
+    : cell_size_(cell_size), width_(0), height_(0)
+{
+    if(points.empty()) {
+        return;
+    }
+
+    cv::Point2f min = points.front();
+    cv::Point2f max = min;
+    for(const cv::Point2f& pt : points) {
+        min.x = std::min(min.x, pt.x);
+        min.y = std::min(min.y, pt.y);
+        max.x = std::max(max.x, pt.x);
+        max.y = std::max(max.y, pt.y);
+    }
+
+    // sparse clouds spread over a large area would otherwise need more memory for the cells than for the points
+    double area = std::max(1e-6, double(max.x - min.x) * double(max.y - min.y));
+    cell_size_ = std::max<double>(cell_size_, std::sqrt(area / points.size()));
+
+    origin_ = min;
+    width_ = cellX(max.x) + 1;
+    height_ = cellY(max.y) + 1;
+
+    // counting sort of the points by cell
+    std::vector<std::size_t> cell_of_point(points.size());
+    offsets_.assign(width_ * height_ + 1, 0);
+    for(std::size_t i = 0; i < points.size(); ++i) {
+        std::size_t cell = cellY(points[i].y) * width_ + cellX(points[i].x);
+        cell_of_point[i] = cell;
+        ++offsets_[cell + 1];
+    }
+    for(std::size_t c = 1; c < offsets_.size(); ++c) {
+        offsets_[c] += offsets_[c - 1];
+    }
+
+    std::vector<std::size_t> next(offsets_.begin(), offsets_.end() - 1);
+    points_.resize(points.size());
+    for(std::size_t i = 0; i < points.size(); ++i) {
+        points_[next[cell_of_point[i]]++] = points[i];
+    }
+}
+
+std::size_t ObstacleGridIndex::size() const
+{
+    return points_.size();
+}
+
+bool ObstacleGridIndex::anyInPolygon(const std::vector<cv::Point2f>& polygon) const
+{
+    if(polygon.empty()) {
+        return false;
+    }
+
+    cv::Point2f min = polygon.front();
+    cv::Point2f max = min;
+    for(const cv::Point2f& pt : polygon) {
+        min.x = std::min(min.x, pt.x);
+        min.y = std::min(min.y, pt.y);
+        max.x = std::max(max.x, pt.x);
+        max.y = std::max(max.y, pt.y);
+    }
+
+    cv::Rect_<float> box(min.x, min.y, max.x - min.x, max.y - min.y);
+    return forEachInBox(box, [&](const cv::Point2f& pt) {
+        return pt.x >= min.x && pt.x <= max.x && pt.y >= min.y && pt.y <= max.y &&
+                cv::pointPolygonTest(polygon, pt, false) > 0.5;
+    });
+}
+
+bool ObstacleGridIndex::findNearest(const cv::Point2f& pt, float max_distance, cv::Point2f& nearest) const
+{
+    if(points_.empty()) {
+        return false;
+    }
+
+    // clamping keeps the ring distance a lower bound for points far outside of the grid
+    int cx = std::min(std::max(cellX(std::max(-1e6f, std::min(1e6f, pt.x))), -1), width_);
+    int cy = std::min(std::max(cellY(std::max(-1e6f, std::min(1e6f, pt.y))), -1), height_);
+    int max_ring = std::max(std::max(cx + 1, width_ - cx), std::max(cy + 1, height_ - cy));
+
+    float best = max_distance;
+    bool found = false;
+
+    auto visit = [&](int x, int y) {
+        std::size_t cell = y * width_ + x;
+        for(std::size_t i = offsets_[cell], end = offsets_[cell + 1]; i < end; ++i) {
+            float dist = std::hypot(points_[i].x - pt.x, points_[i].y - pt.y);
+            if(dist < best) {
+                best = dist;
+                nearest = points_[i];
+                found = true;
+            }
+        }
+    };
+
+    for(int r = 0; r <= max_ring; ++r) {
+        // every point in ring r is at least r-1 cells away from pt
+        if(r > 0 && (r - 1) * cell_size_ >= best) {
+            break;
+        }
+
+        int x0 = std::max(0, cx - r);
+        int x1 = std::min(width_ - 1, cx + r);
+        for(int y = std::max(0, cy - r), y1 = std::min(height_ - 1, cy + r); y <= y1; ++y) {
+            if(y == cy - r || y == cy + r) {
+                for(int x = x0; x <= x1; ++x) {
+                    visit(x, y);
+                }
+            } else {
+                if(cx - r >= 0) {
+                    visit(cx - r, y);
+                }
+                if(r > 0 && cx + r < width_) {
+                    visit(cx + r, y);
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+int ObstacleGridIndex::cellX(float x) const
+{
+    return static_cast<int>(std::floor((x - origin_.x) / cell_size_));
+}
+
+int ObstacleGridIndex::cellY(float y) const
+{
+    return static_cast<int>(std::floor((y - origin_.y) / cell_size_));
+}
@@ -7,7 +7,7 @@
 #include <path_follower/parameters/path_follower_parameters.h>
 
 // SYSTEM
-#include <deque>
+#include <algorithm>
 #include <nav_msgs/Path.h>
 #pragma GCC diagnostic ignored "-Wignored-qualifiers"
 #include <interpolation.h>
@@ -34,38 +34,30 @@ void PathInterpolated::interpolatePath(const Path::Ptr path, const bool hack) {
 
     frame_id_ = path->getFrameId();
 
-	std::deque<Waypoint> waypoints;
+    waypoints_.clear();
     while (!path->isDone()) {
-        waypoints.insert(waypoints.end(), path->getCurrentSubPath().wps.begin(), path->getCurrentSubPath().wps.end());
+        const std::vector<Waypoint>& subpath = path->getCurrentSubPath().wps;
+        waypoints_.insert(waypoints_.end(), subpath.begin(), subpath.end());
 
         if(hack){
-            int originalNumWaypoints = waypoints.size();
+            int originalNumWaypoints = waypoints_.size();
             // (messy) hack!!!!!
             // remove waypoints that are closer than 0.1 meters to the starting point
-            Waypoint start = waypoints.front();
-            while(!waypoints.empty()) {
-                std::deque<Waypoint>::iterator it = waypoints.begin();
-                const Waypoint& wp = *it;
-
-                double dx = wp.x - start.x;
-                double dy = wp.y - start.y;
-                double distance = hypot(dx, dy);
-                if(distance < 0.1) {
-                    waypoints.pop_front();
-                } else {
-                    break;
-                }
-            }
+            Waypoint start = waypoints_.front();
+            auto first_far = std::find_if(waypoints_.begin(), waypoints_.end(), [&start](const Waypoint& wp) {
+                return hypot(wp.x - start.x, wp.y - start.y) >= 0.1;
+            });
+            waypoints_.erase(waypoints_.begin(), first_far);
 
             // eliminate subpaths containing only the same points
-            if(waypoints.size() > 1)
+            if(waypoints_.size() > 1)
                 break;
 
             //special case where all waypoints are below 0.1m, keep at least last two waypoints
-            if (originalNumWaypoints >= 2 && waypoints.size() < 2)
+            if (originalNumWaypoints >= 2 && waypoints_.size() < 2)
             {
-                waypoints.insert(waypoints.end(), path->getCurrentSubPath().wps.begin(), path->getCurrentSubPath().wps.end());
-                while (waypoints.size() > 2) waypoints.pop_front();
+                waypoints_.insert(waypoints_.end(), subpath.begin(), subpath.end());
+                if (waypoints_.size() > 2) waypoints_.erase(waypoints_.begin(), waypoints_.end() - 2);
                 break;
             }
 
@@ -79,7 +71,7 @@ void PathInterpolated::interpolatePath(const Path::Ptr path, const bool hack) {
     //path->reset();
 
     try {
-        interpolatePath(waypoints);
+        interpolatePath(waypoints_);
     } catch(const alglib::ap_error& error) {
         throw std::runtime_error(error.msg);
     }
@@ -91,13 +83,10 @@ void PathInterpolated::interpolatePath(const SubPath& path, const std::string& f
 
     frame_id_ = frame_id;
 
-    std::deque<Waypoint> waypoints;
-    waypoints.insert(waypoints.end(),path.wps.begin(),path.wps.end());
-
-    interpolatePath(waypoints);
+    interpolatePath(path.wps);
 }
 
-void PathInterpolated::interpolatePath(const std::deque<Waypoint>& waypoints){
+void PathInterpolated::interpolatePath(const std::vector<Waypoint>& waypoints){
 	//copy the waypoints to arrays X_arr and Y_arr, and introduce a new array l_arr_unif required for the interpolation
 	//as an intermediate step, calculate the arclength of the curve, and do the reparameterization with respect to arclength
 
@@ -108,7 +97,15 @@ void PathInterpolated::interpolatePath(const std::deque<Waypoint>& waypoints){
 		return;
 	}
 
-	double X_arr[N_], Y_arr[N_], l_arr[N_], l_arr_unif[N_];
+    // the buffers only grow, so that following paths of similar length do not allocate
+    x_buf_.resize(N_);
+    y_buf_.resize(N_);
+    l_buf_.resize(N_);
+    l_unif_buf_.resize(N_);
+    double* X_arr = x_buf_.data();
+    double* Y_arr = y_buf_.data();
+    double* l_arr = l_buf_.data();
+    double* l_arr_unif = l_unif_buf_.data();
 	double L = 0;
 
     X_arr[0] = waypoints[0].x;
@@ -169,30 +166,27 @@ void PathInterpolated::interpolatePath(const std::deque<Waypoint>& waypoints){
     }
 
 	//define path components, its derivatives, and curvilinear abscissa, then calculate the path curvature
+    samples_.resize(N_);
 	for(uint i = 0; i < N_; ++i) {
+        Sample& c = samples_[i];
 
-		s_.push_back(l_arr_unif[i]);
+        c.s = l_arr_unif[i];
 
-		p_.push_back(x_s[i]);
-		q_.push_back(y_s[i]);
+        c.p = x_s[i];
+        c.q = y_s[i];
 
-		p_prim_.push_back(x_s_prim[i]);
-		q_prim_.push_back(y_s_prim[i]);
+        c.p_prim = x_s_prim[i];
+        c.q_prim = y_s_prim[i];
 
-		p_sek_.push_back(x_s_sek[i]);
-		q_sek_.push_back(y_s_sek[i]);
+        c.p_sek = x_s_sek[i];
+        c.q_sek = y_s_sek[i];
 
-		curvature_.push_back((x_s_prim[i]*y_s_sek[i] - x_s_sek[i]*y_s_prim[i])/
-									(sqrt(pow((x_s_prim[i]*x_s_prim[i] + y_s_prim[i]*y_s_prim[i]), 3))));
+        c.curvature = (x_s_prim[i]*y_s_sek[i] - x_s_sek[i]*y_s_prim[i])/
+                (sqrt(pow((x_s_prim[i]*x_s_prim[i] + y_s_prim[i]*y_s_prim[i]), 3)));
 
 	}
 
-	assert(p_prim_.size() == N_);
-	assert(q_prim_.size() == N_);
-	assert(p_.size() == N_);
-	assert(q_.size() == N_);
-	assert(p_sek_.size() == N_);
-	assert(q_sek_.size() == N_);
+	assert(samples_.size() == N_);
 	assert(n() == N_);
 }
 
@@ -222,13 +216,12 @@ double PathInterpolated::curvature_sek(const unsigned int i) const {
 PathInterpolated::operator nav_msgs::Path() const {
 
 	nav_msgs::Path path;
-	const unsigned int length = p_.size();
+	path.poses.resize(samples_.size());
 
-	for (uint i = 0; i < length; ++i) {
-		geometry_msgs::PoseStamped poza;
-		poza.pose.position.x = p_[i];
-		poza.pose.position.y = q_[i];
-		path.poses.push_back(poza);
+	for (uint i = 0; i < samples_.size(); ++i) {
+		geometry_msgs::PoseStamped& poza = path.poses[i];
+		poza.pose.position.x = samples_[i].p;
+		poza.pose.position.y = samples_[i].q;
 	}
 
     path.header.frame_id = frame_id_;
@@ -239,15 +232,15 @@ PathInterpolated::operator nav_msgs::Path() const {
 PathInterpolated::operator SubPath() const {
 
     SubPath path(true);
-    path.wps.resize(p_.size());
-    const unsigned int length = p_.size();
-
-    for (uint i = 0; i < length; ++i) {
-        auto& wp = path.wps.at(i);
-        wp.x = p_[i];
-        wp.y = q_[i];
-        wp.orientation = std::atan2(q_prim_[i],p_prim_[i]);
-        wp.s = s_[i];
+    path.wps.resize(samples_.size());
+
+    for (uint i = 0; i < samples_.size(); ++i) {
+        const Sample& c = samples_[i];
+        auto& wp = path.wps[i];
+        wp.x = c.p;
+        wp.y = c.q;
+        wp.orientation = std::atan2(c.q_prim, c.p_prim);
+        wp.s = c.s;
     }
 
     return path;
@@ -261,21 +254,11 @@ Path::Ptr PathInterpolated::getOriginalPath() const
 void PathInterpolated::clearBuffers() {
 	N_ = 0;
 
-	s_.clear();
-
-	p_.clear();
-	q_.clear();
-
-	p_prim_.clear();
-	q_prim_.clear();
-
-	p_sek_.clear();
-	q_sek_.clear();
+	// clear keeps the capacity for the next path
+	samples_.clear();
 
 	s_new_ = 0;
 	s_prim_ = 0;
 
-	curvature_.clear();
-
 	interp_path.poses.clear();
 }
@@ -0,0 +1,103 @@
+/*
+ * Micro-benchmark of PathInterpolated for the access patterns of the controllers.
+ *
+ * Usage: path_interpolated_benchmark [points] [iterations]
+ */
+
+/// PROJECT
+#include <path_follower/utils/path_interpolated.h>
+
+/// SYSTEM
+#include <ros/ros.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+typedef std::chrono::high_resolution_clock Clock;
+
+double nsPer(const Clock::time_point& start, std::size_t count)
+{
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+}
+
+SubPath makePath(int points)
+{
+    // a slalom, so that the curvature is not constant
+    SubPath path(true);
+    for(int i = 0; i < points; ++i) {
+        double x = i * 0.1;
+        path.wps.push_back(Waypoint(x, std::sin(x / 2.0), 0.0));
+    }
+    return path;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    ros::init(argc, argv, "path_interpolated_benchmark", ros::init_options::AnonymousName);
+
+    int points = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    SubPath waypoints = makePath(points);
+    PathInterpolated path;
+
+    // re-interpolation of a path of the same length, as done for every new subpath
+    Clock::time_point start = Clock::now();
+    for(int it = 0; it < iterations; ++it) {
+        path.interpolatePath(waypoints, "map");
+    }
+    double t_interpolate = nsPer(start, iterations) / 1e3;
+
+    const unsigned int n = path.n();
+    double sink = 0.0;
+
+    // orthogonal projection: distance to the remaining points of the path
+    std::size_t accesses = 0;
+    start = Clock::now();
+    for(int it = 0; it < iterations; ++it) {
+        for(unsigned int i = (it * 7) % n; i < n; ++i) {
+            sink += std::hypot(path.p(i) - 1.0, path.q(i) - 2.0);
+            ++accesses;
+        }
+    }
+    double t_projection = nsPer(start, accesses);
+
+    // speed control: curvature look ahead along s
+    accesses = 0;
+    start = Clock::now();
+    for(int it = 0; it < iterations; ++it) {
+        unsigned int i0 = (it * 13) % n;
+        for(unsigned int i = i0; i < n && path.s(i) - path.s(i0) < 5.0; ++i) {
+            sink += std::abs(path.curvature(i));
+            ++accesses;
+        }
+    }
+    double t_look_ahead = nsPer(start, accesses);
+
+    // control law: all values of single points in a pseudo random order
+    accesses = 0;
+    start = Clock::now();
+    for(int it = 0; it < iterations; ++it) {
+        for(unsigned int k = 0; k < n; ++k) {
+            unsigned int i = (k * 7919u) % n;
+            const PathInterpolated::Sample& c = path.sample(i);
+            sink += c.s + c.p + c.q + c.p_prim + c.q_prim + c.p_sek + c.q_sek + c.curvature;
+            ++accesses;
+        }
+    }
+    double t_control = nsPer(start, accesses);
+
+    std::cout << n << " interpolated points, " << iterations << " iterations\n"
+              << "  interpolation:   " << t_interpolate << " us per path\n"
+              << "  projection:      " << t_projection << " ns per point\n"
+              << "  look ahead:      " << t_look_ahead << " ns per point\n"
+              << "  all values:      " << t_control << " ns per point\n"
+              << "(" << sink << ")" << std::endl;
+
+    return 0;
+}
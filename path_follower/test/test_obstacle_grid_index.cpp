@@ -0,0 +1,128 @@
+/**
+ * Test of the ObstacleGridIndex class.
+ */
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <path_follower/utils/obstacle_grid_index.h>
+
+using namespace std;
+
+namespace {
+
+bool anyInPolygonLinear(const vector<cv::Point2f>& points, const vector<cv::Point2f>& polygon)
+{
+    for (const cv::Point2f& pt : points) {
+        if (cv::pointPolygonTest(polygon, pt, false) > 0.5) {
+            return true;
+        }
+    }
+    return false;
+}
+
+float random(float min, float max)
+{
+    return min + (max - min) * (rand() / (float) RAND_MAX);
+}
+
+}
+
+TEST(TestObstacleGridIndex, empty)
+{
+    ObstacleGridIndex index(vector<cv::Point2f>(), 0.2f);
+
+    vector<cv::Point2f> polygon = { {-1, -1}, {1, -1}, {1, 1}, {-1, 1} };
+    ASSERT_EQ(0u, index.size());
+    ASSERT_FALSE(index.anyInPolygon(polygon));
+}
+
+TEST(TestObstacleGridIndex, pointInsideAndOutside)
+{
+    vector<cv::Point2f> points = { {0.5, 0.5}, {3, 3}, {-2, 4} };
+    ObstacleGridIndex index(points, 0.2f);
+    ASSERT_EQ(3u, index.size());
+
+    vector<cv::Point2f> around_first = { {0, 0}, {1, 0}, {1, 1}, {0, 1} };
+    ASSERT_TRUE(index.anyInPolygon(around_first));
+
+    vector<cv::Point2f> free = { {1, 1}, {2, 1}, {2, 2}, {1, 2} };
+    ASSERT_FALSE(index.anyInPolygon(free));
+
+    // completely outside of the grid
+    vector<cv::Point2f> far = { {10, 10}, {11, 10}, {11, 11} };
+    ASSERT_FALSE(index.anyInPolygon(far));
+}
+
+TEST(TestObstacleGridIndex, sameResultAsLinearTest)
+{
+    srand(42);
+
+    vector<cv::Point2f> points;
+    for (int i = 0; i < 2000; ++i) {
+        points.push_back(cv::Point2f(random(-10, 10), random(-10, 10)));
+    }
+    ObstacleGridIndex index(points, 0.2f);
+
+    for (int i = 0; i < 500; ++i) {
+        cv::Point2f center(random(-12, 12), random(-12, 12));
+        vector<cv::Point2f> polygon;
+        for (int j = 0; j < 5; ++j) {
+            polygon.push_back(center + cv::Point2f(random(-0.5, 0.5), random(-0.5, 0.5)));
+        }
+
+        ASSERT_EQ(anyInPolygonLinear(points, polygon), index.anyInPolygon(polygon));
+    }
+}
+
+TEST(TestObstacleGridIndex, forEachInBoxStopsEarly)
+{
+    vector<cv::Point2f> points = { {0, 0}, {0.1, 0.1}, {0.05, 0.05} };
+    ObstacleGridIndex index(points, 1.0f);
+
+    int calls = 0;
+    bool found = index.forEachInBox(cv::Rect_<float>(-1, -1, 2, 2), [&](const cv::Point2f&) {
+        ++calls;
+        return true;
+    });
+
+    ASSERT_TRUE(found);
+    ASSERT_EQ(1, calls);
+}
+
+TEST(TestObstacleGridIndex, findNearestSameAsLinearSearch)
+{
+    srand(7);
+
+    vector<cv::Point2f> points;
+    for (int i = 0; i < 1000; ++i) {
+        points.push_back(cv::Point2f(random(-5, 5), random(-5, 5)));
+    }
+    ObstacleGridIndex index(points, 0.2f);
+
+    for (int i = 0; i < 500; ++i) {
+        // also query points far outside of the grid
+        cv::Point2f pt(random(-50, 50), random(-50, 50));
+        if (i % 2 == 0) {
+            pt = cv::Point2f(random(-6, 6), random(-6, 6));
+        }
+
+        float expected = numeric_limits<float>::infinity();
+        for (const cv::Point2f& p : points) {
+            expected = min(expected, hypot(p.x - pt.x, p.y - pt.y));
+        }
+
+        cv::Point2f nearest;
+        ASSERT_TRUE(index.findNearest(pt, numeric_limits<float>::infinity(), nearest));
+        ASSERT_EQ(expected, hypot(nearest.x - pt.x, nearest.y - pt.y));
+
+        ASSERT_FALSE(index.findNearest(pt, expected, nearest));
+    }
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv){
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
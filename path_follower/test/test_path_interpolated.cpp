@@ -0,0 +1,102 @@
+/**
+ * Test of the PathInterpolated class.
+ */
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <cmath>
+#include <path_follower/utils/path_interpolated.h>
+
+namespace {
+
+SubPath line(int points, double step)
+{
+    SubPath path(true);
+    for (int i = 0; i < points; ++i) {
+        path.wps.push_back(Waypoint(i * step, 0, 0));
+    }
+    return path;
+}
+
+}
+
+TEST(TestPathInterpolated, straightLine)
+{
+    PathInterpolated path;
+    path.interpolatePath(line(11, 1.0), "map");
+
+    ASSERT_EQ(11u, path.n());
+    for (unsigned int i = 0; i < path.n(); ++i) {
+        EXPECT_NEAR(i * 1.0, path.s(i), 1e-9);
+        EXPECT_NEAR(i * 1.0, path.p(i), 1e-6);
+        EXPECT_NEAR(0.0, path.q(i), 1e-9);
+        EXPECT_NEAR(0.0, path.theta_p(i), 1e-9);
+        EXPECT_NEAR(0.0, path.curvature(i), 1e-6);
+
+        const PathInterpolated::Sample& sample = path.sample(i);
+        EXPECT_EQ(path.p(i), sample.p);
+        EXPECT_EQ(path.q_prim(i), sample.q_prim);
+    }
+}
+
+TEST(TestPathInterpolated, reinterpolationReplacesAllPoints)
+{
+    PathInterpolated path;
+    path.interpolatePath(line(50, 0.1), "map");
+    ASSERT_EQ(50u, path.n());
+
+    SubPath shorter(true);
+    for (int i = 0; i < 5; ++i) {
+        shorter.wps.push_back(Waypoint(0, -i * 0.5, 0));
+    }
+    path.interpolatePath(shorter, "odom");
+
+    ASSERT_EQ(5u, path.n());
+    ASSERT_EQ("odom", path.frame_id());
+    for (unsigned int i = 0; i < path.n(); ++i) {
+        EXPECT_NEAR(0.0, path.p(i), 1e-9);
+        EXPECT_NEAR(-i * 0.5, path.q(i), 1e-6);
+    }
+
+    SubPath sub = path;
+    ASSERT_EQ(5u, sub.wps.size());
+    EXPECT_NEAR(-M_PI / 2, sub.wps.back().orientation, 1e-6);
+}
+
+TEST(TestPathInterpolated, dropsDuplicatePoints)
+{
+    SubPath path_with_duplicate = line(5, 1.0);
+    path_with_duplicate.wps.insert(path_with_duplicate.wps.begin() + 2, path_with_duplicate.wps[2]);
+
+    PathInterpolated path;
+    path.interpolatePath(path_with_duplicate, "map");
+
+    ASSERT_EQ(5u, path.n());
+    EXPECT_NEAR(4.0, path.s(path.n() - 1), 1e-9);
+}
+
+TEST(TestPathInterpolated, circleCurvature)
+{
+    const double radius = 2.0;
+
+    SubPath circle(true);
+    for (int i = 0; i <= 60; ++i) {
+        double angle = i * M_PI / 60;
+        circle.wps.push_back(Waypoint(radius * std::sin(angle), radius * (1 - std::cos(angle)), angle));
+    }
+
+    PathInterpolated path;
+    path.interpolatePath(circle, "map");
+
+    // the ends of the spline are not constrained, check the inner part only
+    for (unsigned int i = 10; i + 10 < path.n(); ++i) {
+        EXPECT_NEAR(1.0 / radius, path.curvature(i), 1e-2);
+    }
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv){
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "test_path_interpolated");
+  ros::start();
+  return RUN_ALL_TESTS();
+}
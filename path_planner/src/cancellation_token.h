@@ -0,0 +1,58 @@
+#ifndef CANCELLATION_TOKEN_H
+#define CANCELLATION_TOKEN_H
+
+/// SYSTEM
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+/**
+ * @brief The PlanningCancelledException is thrown out of a search that has been cancelled
+ */
+class PlanningCancelledException : public std::runtime_error
+{
+public:
+    PlanningCancelledException()
+        : std::runtime_error("planning has been cancelled")
+    {}
+};
+
+/**
+ * @brief The CancellationToken class is shared between the requester of a search and the search itself.
+ *        Searches check it cooperatively and unwind via PlanningCancelledException.
+ */
+class CancellationToken
+{
+public:
+    typedef std::shared_ptr<CancellationToken> Ptr;
+
+public:
+    CancellationToken()
+        : cancelled_(false)
+    {}
+
+    void cancel()
+    {
+        cancelled_ = true;
+    }
+
+    bool isCancelled() const
+    {
+        return cancelled_;
+    }
+
+    /**
+     * @brief check throws a PlanningCancelledException, iff the token has been cancelled
+     */
+    void check() const
+    {
+        if(cancelled_) {
+            throw PlanningCancelledException();
+        }
+    }
+
+private:
+    std::atomic<bool> cancelled_;
+};
+
+#endif // CANCELLATION_TOKEN_H
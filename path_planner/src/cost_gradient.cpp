@@ -0,0 +1,181 @@
+/// HEADER
+#include "cost_gradient.h"
+
+/// SYSTEM
+#include <algorithm>
+#include <cmath>
+
+CostGradient::CostGradient(int window_radius)
+    : d_(window_radius),
+      cost_(nullptr), width_(0), height_(0), revision_(0), has_revision_(false),
+      tiles_x_(0), tiles_y_(0), cells_evaluated_(0)
+{
+
+}
+
+void CostGradient::setCostMap(const uint8_t *data, int width, int height, std::size_t revision)
+{
+    cost_ = data;
+
+    if(has_revision_ && revision == revision_ && width == width_ && height == height_) {
+        return;
+    }
+
+    width_ = width;
+    height_ = height;
+    revision_ = revision;
+    has_revision_ = true;
+
+    tiles_x_ = (width_ + TILE_SIZE - 1) / TILE_SIZE;
+    tiles_y_ = (height_ + TILE_SIZE - 1) / TILE_SIZE;
+
+    tiles_.clear();
+    tiles_.resize(tiles_x_ * tiles_y_);
+
+    cells_evaluated_ = 0;
+}
+
+int CostGradient::width() const
+{
+    return width_;
+}
+
+int CostGradient::height() const
+{
+    return height_;
+}
+
+std::size_t CostGradient::cellsEvaluated() const
+{
+    return cells_evaluated_;
+}
+
+bool CostGradient::isComputed(int x, int y) const
+{
+    if(x < 0 || x >= width_ || y < 0 || y >= height_) {
+        return false;
+    }
+    return tiles_[(y / TILE_SIZE) * tiles_x_ + (x / TILE_SIZE)] != nullptr;
+}
+
+void CostGradient::get(int x, int y, float &gx, float &gy)
+{
+    if(x < 0 || x >= width_ || y < 0 || y >= height_) {
+        gx = 0.f;
+        gy = 0.f;
+        return;
+    }
+
+    int tx = x / TILE_SIZE;
+    int ty = y / TILE_SIZE;
+
+    Tile* tile = tiles_[ty * tiles_x_ + tx].get();
+    if(!tile) {
+        tile = computeTile(tx, ty);
+    }
+
+    std::size_t idx = (y - ty * TILE_SIZE) * TILE_SIZE + (x - tx * TILE_SIZE);
+    gx = tile->gx[idx];
+    gy = tile->gy[idx];
+}
+
+CostGradient::Tile* CostGradient::computeTile(int tx, int ty)
+{
+    std::unique_ptr<Tile>& tile = tiles_[ty * tiles_x_ + tx];
+    tile.reset(new Tile);
+    std::fill(tile->gx, tile->gx + TILE_SIZE * TILE_SIZE, 0.f);
+    std::fill(tile->gy, tile->gy + TILE_SIZE * TILE_SIZE, 0.f);
+
+    const int d = d_;
+
+    const int x0 = tx * TILE_SIZE;
+    const int y0 = ty * TILE_SIZE;
+    const int x1 = std::min(width_, x0 + TILE_SIZE);
+    const int y1 = std::min(height_, y0 + TILE_SIZE);
+    const int cols = x1 - x0;
+
+    /// row pass: minimum cost in [x-d, x+d] and the offset of the closest cell attaining it
+    const int ry0 = std::max(0, y0 - d);
+    const int ry1 = std::min(height_, y1 + d);
+
+    row_cost_.resize((ry1 - ry0) * cols);
+    row_dx_.resize((ry1 - ry0) * cols);
+
+    for(int y = ry0; y < ry1; ++y) {
+        const uint8_t* row = cost_ + y * width_;
+        int* min_cost_row = &row_cost_[(y - ry0) * cols];
+        int* min_dx_row = &row_dx_[(y - ry0) * cols];
+
+        for(int x = x0; x < x1; ++x) {
+            int startx = std::max(0, x - d);
+            int endx = std::min(width_ - 1, x + d);
+
+            int min_cost = 512;
+            int min_dx = 0;
+            for(int nx = startx; nx <= endx; ++nx) {
+                int ncost = row[nx];
+                int dx = nx - x;
+                if(ncost < min_cost || (ncost == min_cost && std::abs(dx) < std::abs(min_dx))) {
+                    min_cost = ncost;
+                    min_dx = dx;
+                }
+            }
+
+            min_cost_row[x - x0] = min_cost;
+            min_dx_row[x - x0] = min_dx;
+        }
+    }
+
+    /// column pass: combine the row minima, ties are broken by the distance to the cell
+    for(int y = y0; y < y1; ++y) {
+        int starty = std::max(0, y - d);
+        int endy = std::min(height_ - 1, y + d);
+
+        for(int x = x0; x < x1; ++x) {
+            int cost = cost_[y * width_ + x];
+            if(cost == 0) {
+                continue;
+            }
+
+            int min_cost = 512;
+            int min_dist_sqr = 0;
+            int min_dx = 0;
+            int min_dy = 0;
+            for(int ny = starty; ny <= endy; ++ny) {
+                std::size_t row_idx = (ny - ry0) * cols + (x - x0);
+                int ncost = row_cost_[row_idx];
+                int ndx = row_dx_[row_idx];
+                int ndy = ny - y;
+                int dist_sqr = ndx * ndx + ndy * ndy;
+                if(ncost < min_cost || (ncost == min_cost && dist_sqr < min_dist_sqr)) {
+                    min_cost = ncost;
+                    min_dist_sqr = dist_sqr;
+                    min_dx = ndx;
+                    min_dy = ndy;
+                }
+            }
+
+            if(min_dist_sqr > 0) {
+                // point away from the minimum, the length is proportional to the cost
+                int dx = -min_dx;
+                int dy = -min_dy;
+
+                float norm = std::sqrt((float) min_dist_sqr);
+                float len = cost / 10.0;
+
+                float f = len / norm;
+
+                dx *= f;
+                dy *= f;
+
+                std::size_t idx = (y - y0) * TILE_SIZE + (x - x0);
+                tile->gx[idx] = dx;
+                tile->gy[idx] = dy;
+            }
+        }
+    }
+
+    cells_evaluated_ += cols * (y1 - y0);
+
+    return tile.get();
+}
@@ -0,0 +1,87 @@
+#ifndef COST_GRADIENT_H
+#define COST_GRADIENT_H
+
+/// SYSTEM
+#include <stdint.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief The CostGradient class computes, for every cell of a cost map, the direction
+ *        towards the cell with the lowest cost in a square window around it.
+ *
+ * The window minimum is found with two separable passes (rows, then columns), so each
+ * cell costs O(window size) instead of O(window size^2). The gradient is evaluated lazily
+ * in tiles of TILE_SIZE x TILE_SIZE cells when a cell is first queried, and the tiles are
+ * kept until the cost map revision changes.
+ */
+class CostGradient
+{
+public:
+    enum { TILE_SIZE = 32 };
+
+public:
+    /**
+     * @brief CostGradient
+     * @param window_radius the minimum is searched in [x-r, x+r] x [y-r, y+r]
+     */
+    CostGradient(int window_radius = 5);
+
+    /**
+     * @brief setCostMap sets the cost map to operate on, cached values are dropped iff the revision changes
+     * @param data row major cost values, has to stay valid while the gradient is used
+     * @param width
+     * @param height
+     * @param revision identifies the content of <data>
+     */
+    void setCostMap(const uint8_t* data, int width, int height, std::size_t revision);
+
+    /**
+     * @brief get returns the gradient at the given cell, computing its tile if necessary
+     * @note cells outside of the map have no gradient
+     */
+    void get(int x, int y, float& gx, float& gy);
+
+    /**
+     * @brief isComputed checks if the gradient at the given cell is already known
+     */
+    bool isComputed(int x, int y) const;
+
+    /**
+     * @brief cellsEvaluated returns the number of cells computed for the current revision
+     */
+    std::size_t cellsEvaluated() const;
+
+    int width() const;
+    int height() const;
+
+private:
+    struct Tile
+    {
+        float gx[TILE_SIZE * TILE_SIZE];
+        float gy[TILE_SIZE * TILE_SIZE];
+    };
+
+    Tile* computeTile(int tx, int ty);
+
+private:
+    int d_;
+
+    const uint8_t* cost_;
+    int width_;
+    int height_;
+    std::size_t revision_;
+    bool has_revision_;
+
+    int tiles_x_;
+    int tiles_y_;
+    std::vector<std::unique_ptr<Tile>> tiles_;
+    std::size_t cells_evaluated_;
+
+    // intermediate results of the row pass
+    std::vector<int> row_cost_;
+    std::vector<int> row_dx_;
+};
+
+#endif // COST_GRADIENT_H
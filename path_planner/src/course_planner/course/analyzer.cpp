@@ -84,7 +84,7 @@ double Analyzer::calculateEffectiveLengthOfNextSegment(const Node* node) const
 
 bool Analyzer::isSegmentForward(const Segment* segment,
                                 const Eigen::Vector2d& pos,
-                                const Eigen::Vector2d& target) const
+                                const Eigen::Vector2d& target)
 {
     Eigen::Vector2d segment_dir = segment->line.endPoint() - segment->line.startPoint();
     Eigen::Vector2d move_dir = target - pos;
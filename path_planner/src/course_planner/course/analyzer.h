@@ -24,7 +24,7 @@ public:
 
     double calculateEffectiveLengthOfNextSegment(const Node* node) const;
 
-    bool isSegmentForward(const Segment* segment, const Eigen::Vector2d& pos, const Eigen::Vector2d& target) const;
+    static bool isSegmentForward(const Segment* segment, const Eigen::Vector2d& pos, const Eigen::Vector2d& target);
     bool isNextSegmentForward(const Node* node) const;
     bool isPreviousSegmentForward(const Node* current_node) const;
     bool isStartSegmentForward(const Node *node) const;
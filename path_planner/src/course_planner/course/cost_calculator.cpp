@@ -9,46 +9,59 @@ CostCalculator::CostCalculator(Search &search)
 
       pnh_("~")
 {
-    pnh_.param("course/penalty/backwards", backward_penalty_factor, 2.5);
-    pnh_.param("course/penalty/turn", turning_penalty, 5.0);
+    pnh_.param("course/penalty/backwards", costs_.backward_penalty_factor, 2.5);
+    pnh_.param("course/penalty/turn", costs_.turning_penalty, 5.0);
 
-    pnh_.param("course/turning/straight", turning_straight_segment, 0.7);
+    pnh_.param("course/turning/straight", costs_.turning_straight_segment, 0.7);
+}
+
+const CostCalculator::Costs& CostCalculator::costs() const
+{
+    return costs_;
 }
 
 double CostCalculator::calculateStraightCost(Node* node, const Eigen::Vector2d& start_point_on_segment, const Eigen::Vector2d& end_point_on_segment) const
 {
-    double cost = 0.0;
     bool segment_forward = isSegmentForward(node->next_segment, start_point_on_segment, end_point_on_segment);
     double distance_to_end = (end_point_on_segment - start_point_on_segment).norm();
-    if(segment_forward) {
-        cost += distance_to_end;
-    } else {
-        cost += backward_penalty_factor * distance_to_end;
-    }
 
-    bool prev_segment_forward = isPreviousSegmentForward(node);
-    if(prev_segment_forward != segment_forward) {
-        // single turn
-        cost += turning_straight_segment;
-        cost += turning_penalty;
+    return straightCost(costs_, distance_to_end, segment_forward) +
+            turningCost(costs_, node->previous_forward, segment_forward, node->curve_forward);
+}
 
-    } else if(segment_forward != node->curve_forward) {
-        // double turn
-        cost += 2 * turning_straight_segment;
-        cost += 2 * turning_penalty;
-    }
+double CostCalculator::calculateCurveCost(Node *node) const
+{
+    return curveCost(costs_, *node->transition, node->curve_forward);
+}
 
-    return cost;
+double CostCalculator::curveCost(const Costs& costs, const Transition& transition, bool curve_forward)
+{
+    if(curve_forward) {
+        return transition.arc_length();
+    } else {
+        return costs.backward_penalty_factor * transition.arc_length();
+    }
 }
 
-double CostCalculator::calculateCurveCost(Node *node) const
+double CostCalculator::straightCost(const Costs& costs, double distance, bool segment_forward)
 {
-    if(node->curve_forward) {
-        return node->transition->arc_length();
+    if(segment_forward) {
+        return distance;
     } else {
-        return backward_penalty_factor * node->transition->arc_length();
+        return costs.backward_penalty_factor * distance;
     }
 }
 
+double CostCalculator::turningCost(const Costs& costs, bool previous_forward, bool segment_forward, bool curve_forward)
+{
+    if(previous_forward != segment_forward) {
+        // single turn
+        return costs.turning_straight_segment + costs.turning_penalty;
 
+    } else if(segment_forward != curve_forward) {
+        // double turn
+        return 2 * costs.turning_straight_segment + 2 * costs.turning_penalty;
+    }
 
+    return 0.0;
+}
@@ -14,18 +14,35 @@ class CostCalculator : public Analyzer
 public:
     friend class Search;
 
+    /**
+     * @brief The Costs struct contains the penalties of the cost model
+     */
+    struct Costs
+    {
+        double backward_penalty_factor;
+        double turning_straight_segment;
+        double turning_penalty;
+    };
+
+public:
     CostCalculator(Search& search);
 
+    const Costs& costs() const;
+
     double calculateStraightCost(Node* current_node, const Eigen::Vector2d &start_point_on_segment, const Eigen::Vector2d &end_point_on_segment) const;
     double calculateCurveCost(Node* current_node) const;
 
+    /**
+     * The cost model, shared by the graph search and the TransitionTable, so that both find the same paths.
+     */
+    static double curveCost(const Costs& costs, const Transition& transition, bool curve_forward);
+    static double straightCost(const Costs& costs, double distance, bool segment_forward);
+    static double turningCost(const Costs& costs, bool previous_forward, bool segment_forward, bool curve_forward);
+
 private:
     ros::NodeHandle pnh_;
 
-    double backward_penalty_factor;
-    double turning_straight_segment;
-    double turning_penalty;
-
+    Costs costs_;
 };
 
 #endif // COST_CALCULATOR_H
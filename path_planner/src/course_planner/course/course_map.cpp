@@ -3,15 +3,50 @@
 #include <ros/console.h>
 #include <visualization_msgs/MarkerArray.h>
 #include <XmlRpcValue.h>
+#include <chrono>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace Eigen;
 
+namespace
+{
+const uint32_t CACHE_MAGIC = 0x314d4343; // "CCM1"
+
+struct CacheHeader
+{
+    uint32_t magic;
+    uint32_t size_of_header;
+    uint64_t hash;
+    uint64_t segments;
+    uint64_t transitions;
+    uint64_t points;
+};
+
+struct CacheTransition
+{
+    uint64_t from;
+    uint64_t to;
+    double intersection[2];
+    double icr[2];
+    double r;
+    double dtheta;
+    uint64_t first_point;
+    uint64_t point_count;
+};
+}
+
 CourseMap::CourseMap(ros::NodeHandle &nh)
-    : nh_(nh), pnh_("~")
+    : transition_count_(0), revision_(0), closest_segment_queries_(0), closest_segment_ns_(0), nh_(nh), pnh_("~")
 {
     pub_viz_ = nh.advertise<visualization_msgs::MarkerArray>("visualization_marker_array", 100, true);
 
     pnh_.param("course/radius", curve_radius, 1.0);
+    pnh_.param("course/index/cell_size", index_cell_size_, 2.0);
+    pnh_.param("course/cache_file", cache_file_, std::string(""));
 }
 
 CourseMap::~CourseMap()
@@ -52,29 +87,55 @@ Segment CourseMap::readSegment(const XmlRpc::XmlRpcValue &map_segment_array, int
 
 const Segment* CourseMap::findClosestSegment(const path_geom::PathPose &pose, double yaw_tolerance, double max_dist) const
 {
+    auto start = std::chrono::steady_clock::now();
+
     Eigen::Vector2d pt = pose.pos_;
     double yaw = pose.theta_;
 
     double best_dist = max_dist + std::numeric_limits<double>::epsilon();
-    const Segment* best_segment = nullptr;
+    std::size_t best_index = segments_.size();
+
+    segment_index_.forEachCandidate(pt, best_dist, [&](std::size_t index) {
+        const Segment& segment = segments_[index];
+
+        Eigen::Vector2d nearest = segment.line.nearestPointTo(pt);
+        double dist = (nearest - pt).norm();
+        // prefer the lower index on ties, like a linear scan
+        bool closer = dist < best_dist || (dist == best_dist && index < best_index && best_index < segments_.size());
+        if(!closer) {
+            return;
+        }
 
-    for(const Segment& segment : segments_) {
         Eigen::Vector2d delta = segment.line.endPoint() - segment.line.startPoint();
         double s_yaw = std::atan2(delta(1), delta(0));
-
         if(std::abs(MathHelper::NormalizeAngle(yaw - s_yaw)) > yaw_tolerance) {
-            continue;
+            return;
         }
 
-        Eigen::Vector2d nearest = segment.line.nearestPointTo(pt);
-        double dist = (nearest - pt).norm();
-        if(dist < best_dist) {
-            best_dist = dist;
-            best_segment = &segment;
-        }
-    }
+        best_dist = dist;
+        best_index = index;
+    });
+
+    auto end = std::chrono::steady_clock::now();
+    closest_segment_queries_.fetch_add(1, std::memory_order_relaxed);
+    closest_segment_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(),
+                                  std::memory_order_relaxed);
+
+    return best_index < segments_.size() ? &segments_[best_index] : nullptr;
+}
 
-    return best_segment;
+CourseMap::QueryStatistics CourseMap::getClosestSegmentStatistics() const
+{
+    QueryStatistics stats;
+    stats.queries = closest_segment_queries_.load();
+    stats.seconds = closest_segment_ns_.load() * 1e-9;
+    return stats;
+}
+
+void CourseMap::resetClosestSegmentStatistics()
+{
+    closest_segment_queries_ = 0;
+    closest_segment_ns_ = 0;
 }
 
 void CourseMap::load(const XmlRpc::XmlRpcValue &map_segment_array)
@@ -83,6 +144,33 @@ void CourseMap::load(const XmlRpc::XmlRpcValue &map_segment_array)
         segments_.emplace_back(readSegment(map_segment_array, i));
     }
 
+    if(cache_file_.empty() || !readCache(cache_file_)) {
+        calculateTransitions();
+
+        if(!cache_file_.empty() && writeCache(cache_file_)) {
+            ROS_INFO_STREAM("wrote course map cache " << cache_file_);
+        }
+    }
+
+    // the transitions don't move anymore -> number them for flat lookup tables
+    transition_count_ = 0;
+    for(Segment& segment : segments_) {
+        for(Transition& t : segment.forward_transitions) {
+            t.id = transition_count_++;
+        }
+        for(Transition& t : segment.backward_transitions) {
+            t.id = transition_count_++;
+        }
+    }
+
+    segment_index_.build(segments_, index_cell_size_);
+
+    ++revision_;
+}
+
+
+void CourseMap::calculateTransitions()
+{
     for(std::size_t i = 0; i < segments_.size(); ++i) {
         for(std::size_t j = 0; j < segments_.size(); ++j) {
             if(i == j) {
@@ -113,6 +201,151 @@ void CourseMap::load(const XmlRpc::XmlRpcValue &map_segment_array)
     }
 }
 
+uint64_t CourseMap::hashSource() const
+{
+    // FNV-1a over everything the transitions are calculated from
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](double value) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+        for(std::size_t i = 0; i < sizeof(value); ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+
+    add(curve_radius);
+    add(segments_.size());
+    for(const Segment& segment : segments_) {
+        add(segment.line.startPoint()(0));
+        add(segment.line.startPoint()(1));
+        add(segment.line.endPoint()(0));
+        add(segment.line.endPoint()(1));
+    }
+    return hash;
+}
+
+bool CourseMap::readCache(const std::string& file)
+{
+    int fd = open(file.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (std::size_t) st.st_size < sizeof(CacheHeader)) {
+        close(fd);
+        return false;
+    }
+
+    std::size_t size = st.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapped == MAP_FAILED) {
+        return false;
+    }
+
+    const char* data = static_cast<const char*>(mapped);
+    const CacheHeader* header = reinterpret_cast<const CacheHeader*>(data);
+    const CacheTransition* transitions = reinterpret_cast<const CacheTransition*>(data + sizeof(CacheHeader));
+    const double* points = reinterpret_cast<const double*>(transitions + header->transitions);
+
+    bool valid = header->magic == CACHE_MAGIC &&
+            header->size_of_header == sizeof(CacheHeader) &&
+            header->hash == hashSource() &&
+            header->segments == segments_.size() &&
+            size == sizeof(CacheHeader) + header->transitions * sizeof(CacheTransition) + header->points * 2 * sizeof(double);
+
+    for(uint64_t i = 0; valid && i < header->transitions; ++i) {
+        const CacheTransition& ct = transitions[i];
+        valid = ct.from < segments_.size() && ct.to < segments_.size() && ct.first_point + ct.point_count <= header->points;
+    }
+
+    if(!valid) {
+        ROS_WARN_STREAM("course map cache " << file << " does not match the course, recalculating it");
+        munmap(mapped, size);
+        return false;
+    }
+
+    for(uint64_t i = 0; i < header->transitions; ++i) {
+        const CacheTransition& ct = transitions[i];
+        Segment& from = segments_[ct.from];
+        Segment& to = segments_[ct.to];
+
+        Transition t;
+        t.source = &from;
+        t.target = &to;
+        t.intersection = Eigen::Vector2d(ct.intersection[0], ct.intersection[1]);
+        t.icr = Eigen::Vector2d(ct.icr[0], ct.icr[1]);
+        t.r = ct.r;
+        t.dtheta = ct.dtheta;
+
+        const double* pt = points + 2 * ct.first_point;
+        t.path.reserve(ct.point_count);
+        for(uint64_t p = 0; p < ct.point_count; ++p, pt += 2) {
+            t.path.emplace_back(pt[0], pt[1]);
+        }
+
+        intersections_.push_back(t.intersection);
+        from.forward_transitions.emplace_back(t);
+        to.backward_transitions.emplace_back(std::move(t));
+    }
+
+    munmap(mapped, size);
+    return true;
+}
+
+bool CourseMap::writeCache(const std::string& file) const
+{
+    // every transition is stored once, ordered by source and target like in calculateTransitions,
+    // so that reading the cache restores the order of all transition lists
+    std::vector<const Transition*> transitions;
+    for(const Segment& segment : segments_) {
+        for(const Transition& t : segment.forward_transitions) {
+            transitions.push_back(&t);
+        }
+    }
+
+    CacheHeader header;
+    header.magic = CACHE_MAGIC;
+    header.size_of_header = sizeof(CacheHeader);
+    header.hash = hashSource();
+    header.segments = segments_.size();
+    header.transitions = transitions.size();
+    header.points = 0;
+
+    std::vector<CacheTransition> records;
+    std::vector<double> points;
+    for(const Transition* t : transitions) {
+        CacheTransition ct;
+        ct.from = t->source - segments_.data();
+        ct.to = t->target - segments_.data();
+        ct.intersection[0] = t->intersection(0);
+        ct.intersection[1] = t->intersection(1);
+        ct.icr[0] = t->icr(0);
+        ct.icr[1] = t->icr(1);
+        ct.r = t->r;
+        ct.dtheta = t->dtheta;
+        ct.first_point = header.points;
+        ct.point_count = t->path.size();
+        records.push_back(ct);
+
+        for(const Eigen::Vector2d& pt : t->path) {
+            points.push_back(pt(0));
+            points.push_back(pt(1));
+        }
+        header.points += t->path.size();
+    }
+
+    std::ofstream out(file, std::ios::binary);
+    if(!out) {
+        ROS_ERROR_STREAM("cannot write course map cache " << file);
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(CacheTransition));
+    out.write(reinterpret_cast<const char*>(points.data()), points.size() * sizeof(double));
+    return out.good();
+}
 
 void CourseMap::addTransition(Segment &from, Segment &to, const Eigen::Vector2d& intersection)
 {
@@ -385,3 +618,13 @@ const std::vector<Segment>& CourseMap::getSegments() const
 {
     return segments_;
 }
+
+std::size_t CourseMap::getTransitionCount() const
+{
+    return transition_count_;
+}
+
+uint64_t CourseMap::getRevision() const
+{
+    return revision_;
+}
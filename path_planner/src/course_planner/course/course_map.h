@@ -7,9 +7,19 @@
 #include <visualization_msgs/MarkerArray.h>
 
 #include "segment.h"
+#include "segment_index.h"
+
+#include <atomic>
 
 class CourseMap
 {
+public:
+    struct QueryStatistics
+    {
+        std::size_t queries;
+        double seconds;
+    };
+
 public:
     CourseMap(ros::NodeHandle& nh);
     ~CourseMap();
@@ -19,14 +29,31 @@ public:
 
     const Segment* findClosestSegment(const path_geom::PathPose& pose, double yaw_tolerance, double max_dist) const;
 
+    /**
+     * @brief getClosestSegmentStatistics returns the number of findClosestSegment calls and the time spent in them
+     */
+    QueryStatistics getClosestSegmentStatistics() const;
+    void resetClosestSegmentStatistics();
+
     bool hasSegments() const;
     const std::vector<Segment> &getSegments() const;
+    std::size_t getTransitionCount() const;
+
+    /**
+     * @brief getRevision is incremented every time the course is loaded
+     */
+    uint64_t getRevision() const;
 
 private:
     static Eigen::Vector2d readPoint(const XmlRpc::XmlRpcValue& value, int index);
     static Segment readSegment(const XmlRpc::XmlRpcValue& value, int index);
 
     void addTransition(Segment &from, Segment &to, const Eigen::Vector2d &intersection);
+    void calculateTransitions();
+
+    uint64_t hashSource() const;
+    bool readCache(const std::string& file);
+    bool writeCache(const std::string& file) const;
 
     Eigen::Vector2d calculateICR(const Segment &from, const Segment &to, const Eigen::Vector2d& intersection) const;
     double calculateSpan(const Segment &from, const Segment &to, const Eigen::Vector2d &icr) const;
@@ -39,12 +66,21 @@ private:
 private:
     std::vector<Segment> segments_;
     std::vector<Eigen::Vector2d> intersections_;
+    std::size_t transition_count_;
+    uint64_t revision_;
+
+    SegmentIndex segment_index_;
+    double index_cell_size_;
+
+    mutable std::atomic<std::size_t> closest_segment_queries_;
+    mutable std::atomic<int64_t> closest_segment_ns_;
 
     ros::NodeHandle& nh_;
     ros::NodeHandle pnh_;
     ros::Publisher pub_viz_;
 
     double curve_radius;
+    std::string cache_file_;
 };
 
 #endif // COURSE_MAP_H
@@ -14,12 +14,18 @@ struct Node {
 
     bool curve_forward= true;
 
+    // direction the segment before the transition has been driven in, every transition has a node per direction
+    bool previous_forward = true;
+
     // distance travelled until this transition is reached
     double cost = std::numeric_limits<double>::infinity();
 
     // node via which this transition is reached
     Node* prev = nullptr;
     Node* next = nullptr;
+
+    // position in the NodeQueue, -1 if not queued
+    int heap_index = -1;
 };
 
 #endif // NODE_H
@@ -0,0 +1,80 @@
+#include "node_queue.h"
+#include "node.h"
+
+bool NodeQueue::empty() const
+{
+    return heap_.empty();
+}
+
+void NodeQueue::clear()
+{
+    for(Node* node : heap_) {
+        node->heap_index = -1;
+    }
+    heap_.clear();
+}
+
+void NodeQueue::push(Node *node)
+{
+    if(node->heap_index < 0) {
+        heap_.push_back(node);
+        node->heap_index = heap_.size() - 1;
+    }
+    siftUp(node->heap_index);
+}
+
+Node* NodeQueue::pop()
+{
+    Node* top = heap_.front();
+    top->heap_index = -1;
+
+    Node* last = heap_.back();
+    heap_.pop_back();
+    if(!heap_.empty()) {
+        place(last, 0);
+        siftDown(0);
+    }
+
+    return top;
+}
+
+void NodeQueue::siftUp(std::size_t pos)
+{
+    Node* node = heap_[pos];
+    while(pos > 0) {
+        std::size_t parent = (pos - 1) / 2;
+        if(!(node->cost < heap_[parent]->cost)) {
+            break;
+        }
+        place(heap_[parent], pos);
+        pos = parent;
+    }
+    place(node, pos);
+}
+
+void NodeQueue::siftDown(std::size_t pos)
+{
+    Node* node = heap_[pos];
+    std::size_t n = heap_.size();
+    while(true) {
+        std::size_t child = 2 * pos + 1;
+        if(child >= n) {
+            break;
+        }
+        if(child + 1 < n && heap_[child + 1]->cost < heap_[child]->cost) {
+            ++child;
+        }
+        if(!(heap_[child]->cost < node->cost)) {
+            break;
+        }
+        place(heap_[child], pos);
+        pos = child;
+    }
+    place(node, pos);
+}
+
+void NodeQueue::place(Node *node, std::size_t pos)
+{
+    heap_[pos] = node;
+    node->heap_index = pos;
+}
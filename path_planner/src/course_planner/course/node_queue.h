@@ -0,0 +1,37 @@
+#ifndef NODE_QUEUE_H
+#define NODE_QUEUE_H
+
+#include <vector>
+
+struct Node;
+
+/**
+ * @brief The NodeQueue class is a binary min-heap of nodes ordered by cost.
+ *        Each node stores its heap position, so a queued node can be moved up in O(log n) when its cost decreases.
+ */
+class NodeQueue
+{
+public:
+    bool empty() const;
+    void clear();
+
+    /**
+     * @brief push inserts the node, or restores the heap order if the node is queued and its cost has decreased
+     */
+    void push(Node* node);
+
+    /**
+     * @brief pop removes and returns the node with the lowest cost
+     */
+    Node* pop();
+
+private:
+    void siftUp(std::size_t pos);
+    void siftDown(std::size_t pos);
+    void place(Node* node, std::size_t pos);
+
+private:
+    std::vector<Node*> heap_;
+};
+
+#endif // NODE_QUEUE_H
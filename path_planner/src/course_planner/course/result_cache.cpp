@@ -0,0 +1,49 @@
+#include "result_cache.h"
+
+ResultCache::ResultCache(std::size_t max_entries)
+    : max_entries_(max_entries), hits_(0), misses_(0)
+{
+}
+
+bool ResultCache::get(const Key& key, Entry& entry)
+{
+    auto pos = entries_.find(key);
+    if(pos == entries_.end()) {
+        ++misses_;
+        return false;
+    }
+
+    ++hits_;
+    entry = pos->second;
+
+    lru_.remove(key);
+    lru_.push_front(key);
+    return true;
+}
+
+void ResultCache::put(const Key& key, const Entry& entry)
+{
+    if(max_entries_ == 0) {
+        return;
+    }
+
+    entries_[key] = entry;
+
+    lru_.remove(key);
+    lru_.push_front(key);
+
+    while(lru_.size() > max_entries_) {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+    }
+}
+
+std::size_t ResultCache::hits() const
+{
+    return hits_;
+}
+
+std::size_t ResultCache::misses() const
+{
+    return misses_;
+}
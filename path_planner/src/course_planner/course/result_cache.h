@@ -0,0 +1,83 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <tuple>
+#include <vector>
+
+class Segment;
+
+/**
+ * @brief The ResultCache class keeps the transition chains of recent course searches in LRU order.
+ *        A chain is only valid for other start and end points, if it is still cheaper than every competing chain,
+ *        which is checked with the start and end costs stored in the entry.
+ */
+class ResultCache
+{
+public:
+    struct Key
+    {
+        const Segment* start_segment;
+        const Segment* end_segment;
+
+        // number of transitions whose curve leaves the start segment behind the start point,
+        // this fixes the start state of every transition leaving the start segment
+        std::size_t start_interval;
+
+        bool allow_forward;
+        bool allow_backward;
+        bool reversed;
+
+        uint64_t course_revision;
+
+        bool operator < (const Key& other) const
+        {
+            return std::tie(start_segment, end_segment, start_interval,
+                            allow_forward, allow_backward, reversed, course_revision) <
+                    std::tie(other.start_segment, other.end_segment, other.start_interval,
+                             other.allow_forward, other.allow_backward, other.reversed, other.course_revision);
+        }
+
+        bool operator == (const Key& other) const
+        {
+            return !(*this < other) && !(other < *this);
+        }
+    };
+
+    // TransitionTable::state of each transition on the path, empty if there is no path
+    typedef std::vector<std::size_t> Chain;
+
+    struct Entry
+    {
+        Chain chain;
+        // total cost of the chain, including the start and end cost
+        double cost;
+
+        // cost from the start point to every transition leaving the start segment
+        // and from every transition arriving on the end segment to the end point
+        std::vector<double> start_costs;
+        std::vector<double> end_costs;
+    };
+
+public:
+    ResultCache(std::size_t max_entries);
+
+    bool get(const Key& key, Entry& entry);
+    void put(const Key& key, const Entry& entry);
+
+    std::size_t hits() const;
+    std::size_t misses() const;
+
+private:
+    std::size_t max_entries_;
+
+    std::map<Key, Entry> entries_;
+    std::list<Key> lru_;
+
+    std::size_t hits_;
+    std::size_t misses_;
+};
+
+#endif // RESULT_CACHE_H
@@ -4,20 +4,12 @@
 #include <ros/console.h>
 #include <nav_msgs/OccupancyGrid.h>
 #include <nav_msgs/GetMap.h>
-#include <set>
 #include <tf/tf.h>
 
 #include "course_map.h"
 
 #include "near_course_test.hpp"
 
-namespace {
-bool comp (const Node* lhs, const Node* rhs)
-{
-    return lhs->cost<rhs->cost;
-}
-}
-
 Search::Search(const CourseMap& generator)
     : pnh_("~"),
       cost_calculator_(*this),
@@ -29,15 +21,21 @@ Search::Search(const CourseMap& generator)
 
     pnh_.param("max_distance_for_direct_try", max_distance_for_direct_try, 7.0);
     pnh_.param("max_time_for_direct_try", max_time_for_direct_try, 1.0);
+
+    int cache_size;
+    pnh_.param("course/result_cache/size", cache_size, 64);
+    result_cache_.reset(new ResultCache(std::max(0, cache_size)));
 }
 
 
 path_msgs::PathSequence Search::findPath(lib_path::SimpleGridMap2d * map,
                                          const path_msgs::PlanPathGoal &goal,
                                          const path_geom::PathPose& start_pose,
-                                         const path_geom::PathPose& end_pose)
+                                         const path_geom::PathPose& end_pose,
+                                         const std::function<void()>& check_cancelled)
 {
     map_info = map;
+    check_cancelled_ = check_cancelled;
 
     options_ = goal.options;
     world_frame_ = goal.goal.pose.header.frame_id;
@@ -49,6 +47,7 @@ path_msgs::PathSequence Search::findPath(lib_path::SimpleGridMap2d * map,
         if(!direct.paths.empty()) {
             return direct;
         }
+        checkCancelled();
     }
 
     if(!findAppendices(start_pose, end_pose)) {
@@ -71,6 +70,93 @@ path_msgs::PathSequence Search::findPath(lib_path::SimpleGridMap2d * map,
     return performDijkstraSearch();
 }
 
+path_msgs::PathSequence Search::findCoursePath(const path_geom::PathPose& start_pose, const path_geom::PathPose& end_pose)
+{
+    check_cancelled_ = {};
+
+    start_appendix = {};
+    end_appendix = {};
+
+    start_segment = generator_.findClosestSegment(start_pose, M_PI / 8, 0.5);
+    end_segment = generator_.findClosestSegment(end_pose, M_PI / 8, 0.5);
+    if(!start_segment || !end_segment) {
+        ROS_ERROR_STREAM("start or end pose is not on the course");
+        return {};
+    }
+    start_pt = start_segment->line.nearestPointTo(start_pose.pos_);
+    end_pt = end_segment->line.nearestPointTo(end_pose.pos_);
+
+    if(start_segment == end_segment) {
+        PathBuilder path_builder(*this);
+        path_builder.insertTangentPoint(start_segment, start_pt);
+        path_builder.insertTangentPoint(end_segment, end_pt);
+        return path_builder;
+    }
+
+    return performDijkstraSearch();
+}
+
+
+void Search::loadTransitionTable()
+{
+    transition_table_.reset();
+
+    // the table is stored next to the course cache by default, without a file it would be recomputed on every start
+    std::string cache_file;
+    pnh_.param("course/cache_file", cache_file, std::string(""));
+    std::string file;
+    pnh_.param("course/precompute/file", file, cache_file.empty() ? std::string("") : cache_file + ".transitions");
+
+    bool enabled;
+    pnh_.param("course/precompute/enabled", enabled, !file.empty());
+    if(!enabled) {
+        return;
+    }
+
+    int max_transitions;
+    pnh_.param("course/precompute/max_transitions", max_transitions, 2048);
+    int threads;
+    pnh_.param("course/precompute/threads", threads, 0);
+
+    const TransitionTable::Costs& costs = cost_calculator_.costs();
+
+    if(!file.empty()) {
+        transition_table_ = TransitionTable::load(file, generator_, costs);
+        if(transition_table_) {
+            ROS_INFO_STREAM("loaded transition table from " << file);
+            return;
+        }
+    }
+
+    ros::WallTime start = ros::WallTime::now();
+    TransitionTable::Ptr table = TransitionTable::build(generator_, costs, max_transitions, threads);
+    if(!table) {
+        return;
+    }
+    ROS_INFO_STREAM("precomputed transition table with " << table->stateCount() << " states in "
+                    << (ros::WallTime::now() - start).toSec() << "s");
+
+    if(!file.empty() && table->save(file)) {
+        ROS_INFO_STREAM("saved transition table to " << file);
+    }
+
+    transition_table_ = table;
+}
+
+void Search::setTransitionTable(const TransitionTable::ConstPtr& table)
+{
+    transition_table_ = table;
+}
+
+const ResultCache::Chain& Search::lastChain() const
+{
+    return best_chain;
+}
+
+double Search::lastCost() const
+{
+    return min_cost;
+}
 
 void Search::updateDynamicParameters()
 {
@@ -118,15 +204,46 @@ path_msgs::PathSequence Search::performDijkstraSearch()
 {
     initNodes();
 
-    std::set<Node*, bool(*)(const Node*, const Node*)> priority_queue(&comp);
+    min_cost = std::numeric_limits<double>::infinity();
+    best_path = path_msgs::PathSequence();
+    best_chain.clear();
 
-    enqueueStartingNodes(priority_queue);
+    ResultCache::Key key = makeCacheKey();
+    std::vector<double> start_costs, end_costs;
+    calculateEndpointCosts(start_costs, end_costs);
 
-    min_cost = std::numeric_limits<double>::infinity();
+    ResultCache::Entry entry;
+    if(!result_cache_->get(key, entry) || !replayChain(entry, start_costs, end_costs)) {
+        // a rejected chain may have left costs in the nodes
+        initNodes();
+
+        if(!transition_table_ || !lookUpTransitionTable()) {
+            searchGraph();
+        }
+
+        entry.chain = best_chain;
+        entry.cost = min_cost;
+        entry.start_costs = start_costs;
+        entry.end_costs = end_costs;
+        result_cache_->put(key, entry);
+    }
+
+    PathBuilder path_builder(*this);
+    path_builder.addPath(start_appendix);
+    path_builder.addPath(best_path);
+    path_builder.addPath(end_appendix);
+
+    return path_builder;
+}
+
+void Search::searchGraph()
+{
+    enqueueStartingNodes(priority_queue);
 
     while(!priority_queue.empty()) {
-        Node* current_node = *priority_queue.begin();
-        priority_queue.erase(priority_queue.begin());
+        checkCancelled();
+
+        Node* current_node = priority_queue.pop();
 
         if(current_node->next_segment == end_segment) {
             generatePathCandidate(current_node);
@@ -136,14 +253,8 @@ path_msgs::PathSequence Search::performDijkstraSearch()
         for(int i = 0; i <= 1; ++i) {
             const auto& transitions =  i == 0 ? current_node->next_segment->forward_transitions : current_node->next_segment->backward_transitions;
             for(const Transition& next_transition : transitions) {
-                Node* neighbor = &nodes.at(&next_transition);
-
-                double curve_cost = cost_calculator_.calculateCurveCost(current_node);
-                double straight_cost = cost_calculator_.calculateStraightCost(current_node,
-                                                                      cost_calculator_.findStartPointOnSegment(current_node),
-                                                                      cost_calculator_.findEndPointOnSegment(current_node, &next_transition));
-
-                double new_cost = current_node->cost + curve_cost + straight_cost;
+                double new_cost;
+                Node* neighbor = successor(current_node, next_transition, new_cost);
 
                 if(new_cost < neighbor->cost) {
                     neighbor->cost = new_cost;
@@ -151,52 +262,262 @@ path_msgs::PathSequence Search::performDijkstraSearch()
                     neighbor->prev = current_node;
                     current_node->next = neighbor;
 
-                    if(priority_queue.find(neighbor) != priority_queue.end()) {
-                        priority_queue.erase(neighbor);
-                    }
-                    priority_queue.insert(neighbor);
+                    priority_queue.push(neighbor);
                 }
             }
         }
     }
+}
 
-    PathBuilder path_builder(*this);
-    path_builder.addPath(start_appendix);
-    path_builder.addPath(best_path);
-    path_builder.addPath(end_appendix);
+ResultCache::Key Search::makeCacheKey() const
+{
+    // the start state of a transition changes where the start point passes the start of its curve
+    std::size_t curves_behind = 0;
+    for(int i = 0; i <= 1; ++i) {
+        const auto& transitions = i == 0 ? start_segment->forward_transitions : start_segment->backward_transitions;
+        for(const Transition& t : transitions) {
+            const Eigen::Vector2d& curve_start = i == 0 ? t.path.front() : t.path.back();
+            curves_behind += !cost_calculator_.isSegmentForward(start_segment, start_pt, curve_start);
+        }
+    }
 
-    return path_builder;
+    ResultCache::Key key;
+    key.start_segment = start_segment;
+    key.end_segment = end_segment;
+    key.start_interval = curves_behind;
+    key.allow_forward = options_.allow_forward;
+    key.allow_backward = options_.allow_backward;
+    key.reversed = options_.reversed;
+    key.course_revision = generator_.getRevision();
+    return key;
 }
 
-void Search::enqueueStartingNodes(std::set<Node*, bool(*)(const Node*, const Node*)>& queue)
+void Search::calculateEndpointCosts(std::vector<double>& start_costs, std::vector<double>& end_costs)
 {
+    for(int i = 0; i <= 1; ++i) {
+        const auto& transitions = i == 0 ? start_segment->forward_transitions : start_segment->backward_transitions;
+        for(const Transition& t : transitions) {
+            double cost;
+            startingNode(t, cost);
+            start_costs.push_back(cost);
+        }
+    }
+
+    for(Node& node : nodes) {
+        if(node.next_segment == end_segment) {
+            end_costs.push_back(cost_calculator_.calculateStraightCost(&node, cost_calculator_.findStartPointOnSegment(&node), end_pt));
+        }
+    }
+}
+
+bool Search::replayChain(const ResultCache::Entry& entry, const std::vector<double>& start_costs, const std::vector<double>& end_costs)
+{
+    if(entry.chain.empty()) {
+        // the start states are part of the key, so the end segment is still unreachable
+        return true;
+    }
+    if(entry.start_costs.size() != start_costs.size() || entry.end_costs.size() != end_costs.size()) {
+        return false;
+    }
+
+    /*
+     * Between two requests with the same key, the cost of any chain only changes by the change of its
+     * start and end cost. Every competing chain cost at least entry.cost before, so it now costs at least
+     * entry.cost plus the smallest start and end cost changes. The cached chain is only used below that bound.
+     */
+    double min_start_change = std::numeric_limits<double>::infinity();
+    for(std::size_t i = 0; i < start_costs.size(); ++i) {
+        min_start_change = std::min(min_start_change, start_costs[i] - entry.start_costs[i]);
+    }
+    double min_end_change = std::numeric_limits<double>::infinity();
+    for(std::size_t i = 0; i < end_costs.size(); ++i) {
+        min_end_change = std::min(min_end_change, end_costs[i] - entry.end_costs[i]);
+    }
+
+    // the costs are summed up as in searchGraph
+    Node* prev = &nodes[entry.chain.front()];
+    double cost;
+    if(startingNode(*prev->transition, cost) != prev) {
+        return false;
+    }
+    prev->cost = cost;
+
+    for(std::size_t i = 1; i < entry.chain.size(); ++i) {
+        Node* node = &nodes[entry.chain[i]];
+        if(successor(prev, *node->transition, cost) != node) {
+            return false;
+        }
+        node->cost = cost;
+        node->prev = prev;
+        prev = node;
+    }
+
+    double end_cost = cost_calculator_.calculateStraightCost(prev, cost_calculator_.findStartPointOnSegment(prev), end_pt);
+    double bound = entry.cost + min_start_change + min_end_change;
+    if(prev->cost + end_cost > bound + 1e-9 * std::max(1.0, bound)) {
+        ROS_DEBUG_STREAM("cached chain might not be the cheapest one, searching again");
+        return false;
+    }
+
+    generatePathCandidate(prev);
+    return true;
+}
+
+bool Search::lookUpTransitionTable()
+{
+    const TransitionTable& table = *transition_table_;
+    const std::vector<std::size_t>& arrivals = table.arrivals(end_segment);
+
+    // cost from the curve of each arriving transition to the end point, as in generatePathCandidate
+    std::vector<double> end_costs(2 * arrivals.size());
+    for(std::size_t j = 0; j < end_costs.size(); ++j) {
+        Node* node = &nodes[TransitionTable::state(arrivals[j / 2], j % 2 == 1)];
+        end_costs[j] = cost_calculator_.calculateStraightCost(node, cost_calculator_.findStartPointOnSegment(node), end_pt);
+    }
+
+    double best_cost = std::numeric_limits<double>::infinity();
+    Node* best_start = nullptr;
+    double best_start_cost = 0.0;
+    std::size_t best_end = 0;
     for(int i = 0; i <= 1; ++i) {
         const auto& transitions = i == 0 ? start_segment->forward_transitions : start_segment->backward_transitions;
         for(const Transition& next_transition : transitions) {
+            double start_cost;
+            Node* start_node = startingNode(next_transition, start_cost);
+
+            std::size_t start_state = TransitionTable::state(next_transition.id, start_node->previous_forward);
+            for(std::size_t j = 0; j < end_costs.size(); ++j) {
+                std::size_t end_state = TransitionTable::state(arrivals[j / 2], j % 2 == 1);
+                double cost = start_cost + table.cost(start_state, end_state) + end_costs[j];
+                if(cost < best_cost) {
+                    best_cost = cost;
+                    best_start = start_node;
+                    best_start_cost = start_cost;
+                    best_end = end_state;
+                }
+            }
+        }
+    }
+
+    if(!best_start) {
+        return true;
+    }
+
+    // follow the cheapest successors to recover the transitions, the costs are summed up as in searchGraph
+    Node* current_node = best_start;
+    current_node->cost = best_start_cost;
+    for(std::size_t state = current_node - nodes.data(); state != best_end;) {
+        std::size_t next_state;
+        if(!table.next(state, best_end, next_state)) {
+            ROS_WARN_STREAM("transition table is inconsistent, falling back to graph search");
+            initNodes();
+            return false;
+        }
+
+        if(current_node->next_segment == end_segment) {
+            // the path leaves the end segment again, searchGraph never expands the end segment
+            initNodes();
+            return false;
+        }
+
+        Node* next_node = &nodes[next_state];
+        if(next_node->cost < std::numeric_limits<double>::infinity()) {
+            // the path passes a state twice, which Node cannot represent
+            initNodes();
+            return false;
+        }
+
+        double cost;
+        if(successor(current_node, *next_node->transition, cost) != next_node) {
+            ROS_WARN_STREAM("transition table does not match the course, falling back to graph search");
+            initNodes();
+            return false;
+        }
+        next_node->cost = cost;
+        next_node->prev = current_node;
+
+        current_node = next_node;
+        state = next_state;
+    }
+
+    generatePathCandidate(current_node);
+
+    return true;
+}
+
+Node* Search::startingNode(const Transition& transition, double& cost)
+{
+    // the start segment is driven from start_pt to the curve of the transition
+    Node* node = &nodes[TransitionTable::state(transition.id, true)];
+    Eigen::Vector2d curve_start = cost_calculator_.findEndPointOnSegment(node, &transition);
+    bool start_forward = cost_calculator_.isSegmentForward(start_segment, start_pt, curve_start);
+
+    node = &nodes[TransitionTable::state(transition.id, start_forward)];
+    cost = cost_calculator_.calculateStraightCost(node, start_pt, curve_start);
+    return node;
+}
+
+Node* Search::successor(Node* current_node, const Transition& next_transition, double& cost)
+{
+    // the curve of the next transition leaves the segment at the end given by its own direction
+    Eigen::Vector2d curve_end = cost_calculator_.findStartPointOnSegment(current_node, current_node->transition);
+    Eigen::Vector2d curve_start = cost_calculator_.findEndPointOnSegment(&nodes[TransitionTable::state(next_transition.id, true)],
+                                                                         &next_transition);
+    bool segment_forward = cost_calculator_.isSegmentForward(current_node->next_segment, curve_end, curve_start);
 
-            Node* node = &nodes.at(&next_transition);
+    double curve_cost = cost_calculator_.calculateCurveCost(current_node);
+    double straight_cost = cost_calculator_.calculateStraightCost(current_node, curve_end, curve_start);
+    cost = current_node->cost + curve_cost + straight_cost;
 
-            // distance from start_pt to transition
-            Eigen::Vector2d  end_point_on_segment = node->curve_forward ? next_transition.path.front() : next_transition.path.back();
-            node->cost = cost_calculator_.calculateStraightCost(node, start_pt, end_point_on_segment);
-            queue.insert(node);
+    return &nodes[TransitionTable::state(next_transition.id, segment_forward)];
+}
+
+void Search::enqueueStartingNodes(NodeQueue& queue)
+{
+    for(int i = 0; i <= 1; ++i) {
+        const auto& transitions = i == 0 ? start_segment->forward_transitions : start_segment->backward_transitions;
+        for(const Transition& next_transition : transitions) {
+            double cost;
+            Node* node = startingNode(next_transition, cost);
+            node->cost = cost;
+            queue.push(node);
         }
     }
 }
 
 void Search::initNodes()
 {
-    nodes.clear();
-    for(const Segment& s : generator_.getSegments()) {
-        for(const Transition& t : s.forward_transitions) {
-            nodes[&t].transition = &t;
-            nodes[&t].curve_forward = true;
-            nodes[&t].next_segment = t.target;
+    priority_queue.clear();
+
+    // one node per state of the transition table
+    std::size_t n = 2 * generator_.getTransitionCount();
+    if(nodes.size() == n) {
+        // the graph is unchanged, only reset the search state
+        for(Node& node : nodes) {
+            node.cost = std::numeric_limits<double>::infinity();
+            node.prev = nullptr;
+            node.next = nullptr;
         }
-        for(const Transition& t : s.backward_transitions) {
-            nodes[&t].transition = &t;
-            nodes[&t].curve_forward = false;
-            nodes[&t].next_segment = t.source;
+        return;
+    }
+
+    nodes.assign(n, Node());
+    for(const Segment& s : generator_.getSegments()) {
+        for(int previous_forward = 0; previous_forward <= 1; ++previous_forward) {
+            for(const Transition& t : s.forward_transitions) {
+                Node& node = nodes[TransitionTable::state(t.id, previous_forward)];
+                node.transition = &t;
+                node.curve_forward = true;
+                node.previous_forward = previous_forward;
+                node.next_segment = t.target;
+            }
+            for(const Transition& t : s.backward_transitions) {
+                Node& node = nodes[TransitionTable::state(t.id, previous_forward)];
+                node.transition = &t;
+                node.curve_forward = false;
+                node.previous_forward = previous_forward;
+                node.next_segment = t.source;
+            }
         }
     }
 }
@@ -221,6 +542,8 @@ bool Search::findAppendices(const path_geom::PathPose& start_pose, const path_ge
     }
 
 
+    checkCancelled();
+
     end_appendix = findAppendix(end_pose, "end", true);
     if(end_appendix.paths.empty()) {
         return false;
@@ -255,11 +578,12 @@ path_msgs::PathSequence Search::findAppendix(const path_geom::PathPose& pose, co
     algo.setMap(map_info);
 
     NearCourseTest<AStarSteeringDynamic> goal_test(generator_, algo, map_info);
-    auto path_start = algo.findPath(pose_map, goal_test, [](){});
+    auto callback = [this]() { checkCancelled(); };
+    auto path_start = algo.findPath(pose_map, goal_test, callback);
     if(path_start.empty()) {
         ROS_WARN_STREAM("cannot connect to " << type << " without turning");
         DynamicSteeringNeighborhood::allow_backward = true;
-        path_start = algo.findPath(pose_map, goal_test, [](){});
+        path_start = algo.findPath(pose_map, goal_test, callback);
         if(path_start.empty()) {
             ROS_ERROR_STREAM("cannot connect to " << type);
             return {};
@@ -272,6 +596,13 @@ path_msgs::PathSequence Search::findAppendix(const path_geom::PathPose& pose, co
 
 
 
+void Search::checkCancelled() const
+{
+    if(check_cancelled_) {
+        check_cancelled_();
+    }
+}
+
 path_geom::PathPose Search::convertToWorld(const NodeT& node)
 {
     double tmpx, tmpy;
@@ -337,6 +668,8 @@ void Search::generatePathCandidate(Node* node)
         min_cost = node->cost;
         best_path = path_msgs::PathSequence();
 
+        best_chain.clear();
+
         std::deque<const Node*> transitions;
         Node* tmp = node;
         while(tmp) {
@@ -346,6 +679,9 @@ void Search::generatePathCandidate(Node* node)
             }
             tmp = tmp->prev;
         }
+        for(const Node* n : transitions) {
+            best_chain.push_back(TransitionTable::state(n->transition->id, n->previous_forward));
+        }
 
         PathBuilder path_builder(*this);
         generatePath(transitions, path_builder);
@@ -393,17 +729,17 @@ void Search::generatePath(const std::deque<const Node*>& path_transitions, PathB
                  */
 
                 if(current_node->curve_forward) {
-                    path_builder.extendWithStraightTurningSegment(current_node->transition->path.front(), cost_calculator_.turning_straight_segment);
+                    path_builder.extendWithStraightTurningSegment(current_node->transition->path.front(), cost_calculator_.costs().turning_straight_segment);
                 } else {
-                    path_builder.extendWithStraightTurningSegment(current_node->transition->path.back(), cost_calculator_.turning_straight_segment);
+                    path_builder.extendWithStraightTurningSegment(current_node->transition->path.back(), cost_calculator_.costs().turning_straight_segment);
                 }
 
                 path_builder.insertCurveSegment(current_node);
 
                 if(current_node->curve_forward) {
-                    path_builder.extendAlongTargetSegment(current_node, cost_calculator_.turning_straight_segment);
+                    path_builder.extendAlongTargetSegment(current_node, cost_calculator_.costs().turning_straight_segment);
                 } else {
-                    path_builder.extendAlongSourceSegment(current_node, cost_calculator_.turning_straight_segment);
+                    path_builder.extendAlongSourceSegment(current_node, cost_calculator_.costs().turning_straight_segment);
                 }
             }
 
@@ -422,7 +758,7 @@ void Search::generatePath(const std::deque<const Node*>& path_transitions, PathB
                      *            *
                      */
                     path_builder.insertCurveSegment(current_node);
-                    path_builder.extendAlongTargetSegment(current_node, cost_calculator_.turning_straight_segment);
+                    path_builder.extendAlongTargetSegment(current_node, cost_calculator_.costs().turning_straight_segment);
 
                 } else {
                     // segment (S) forward + curve (C) backward + next segment (N) is backward
@@ -434,7 +770,7 @@ void Search::generatePath(const std::deque<const Node*>& path_transitions, PathB
                      * > > > > > >v> > > > *******
                      *   S                     Extension before curve along target segment of C
                      */
-                    path_builder.extendAlongTargetSegment(current_node, cost_calculator_.turning_straight_segment);
+                    path_builder.extendAlongTargetSegment(current_node, cost_calculator_.costs().turning_straight_segment);
                     path_builder.insertCurveSegment(current_node);
                 }
 
@@ -450,7 +786,7 @@ void Search::generatePath(const std::deque<const Node*>& path_transitions, PathB
                      *            * Extension before curve along source segment of C
                      *            *
                      */
-                    path_builder.extendAlongSourceSegment(current_node, cost_calculator_.turning_straight_segment);
+                    path_builder.extendAlongSourceSegment(current_node, cost_calculator_.costs().turning_straight_segment);
                     path_builder.insertCurveSegment(current_node);
 
                 } else {
@@ -464,7 +800,7 @@ void Search::generatePath(const std::deque<const Node*>& path_transitions, PathB
                      *   N                     Extension after curve along source segment of C
                      */
                     path_builder.insertCurveSegment(current_node);
-                    path_builder.extendAlongSourceSegment(current_node, cost_calculator_.turning_straight_segment);
+                    path_builder.extendAlongSourceSegment(current_node, cost_calculator_.costs().turning_straight_segment);
                 }
             }
         }
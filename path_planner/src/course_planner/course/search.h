@@ -13,10 +13,15 @@
 #include <path_msgs/PathSequence.h>
 #include <path_msgs/PlanPathGoal.h>
 #include <path_msgs/PlannerOptions.h>
+#include <functional>
+#include <memory>
 
 #include "node.h"
+#include "node_queue.h"
 #include "path_builder.h"
 #include "cost_calculator.h"
+#include "transition_table.h"
+#include "result_cache.h"
 
 class CourseMap;
 
@@ -33,18 +38,53 @@ public:
 public:
     Search(const CourseMap& generator);
 
-    path_msgs::PathSequence findPath(lib_path::SimpleGridMap2d *map, const path_msgs::PlanPathGoal &goal, const path_geom::PathPose& start, const path_geom::PathPose& end);
+    /**
+     * @brief findPath connects start and end via the course
+     * @param check_cancelled is called between the searches and during the appendix and graph searches,
+     *        it aborts the search by throwing. The direct try is only limited by max_time_for_direct_try.
+     */
+    path_msgs::PathSequence findPath(lib_path::SimpleGridMap2d *map, const path_msgs::PlanPathGoal &goal, const path_geom::PathPose& start, const path_geom::PathPose& end,
+                                     const std::function<void()>& check_cancelled = {});
+
+    /**
+     * @brief findCoursePath searches only the course graph, start and end have to lie on course segments
+     */
+    path_msgs::PathSequence findCoursePath(const path_geom::PathPose& start, const path_geom::PathPose& end);
+
+    /**
+     * @brief loadTransitionTable reads or precomputes the costs between all transitions of the course map
+     */
+    void loadTransitionTable();
+    void setTransitionTable(const TransitionTable::ConstPtr& table);
+
+    /**
+     * @brief lastChain returns the states (TransitionTable::state) of the transitions found by the last graph search
+     */
+    const ResultCache::Chain& lastChain() const;
+    /**
+     * @brief lastCost returns the cost of the last graph search, infinity if no path was found
+     */
+    double lastCost() const;
 
 private:
+    // the parameters of DynamicSteeringNeighborhood are static, so the direct try and the appendix searches cannot overlap
     path_msgs::PathSequence tryDirectPath(const path_geom::PathPose& start, const path_geom::PathPose& end);
 
     path_msgs::PathSequence findAppendix(const path_geom::PathPose& pose, const std::string& type, bool reversed);
     bool findAppendices(const path_geom::PathPose& start_pose, const path_geom::PathPose& end_pose);
 
     path_msgs::PathSequence performDijkstraSearch();
+    void searchGraph();
+    bool lookUpTransitionTable();
+
+    ResultCache::Key makeCacheKey() const;
+    void calculateEndpointCosts(std::vector<double>& start_costs, std::vector<double>& end_costs);
+    bool replayChain(const ResultCache::Entry& entry, const std::vector<double>& start_costs, const std::vector<double>& end_costs);
     void initNodes();
 
-    void enqueueStartingNodes(std::set<Node *, bool(*)(const Node *, const Node *)> &queue);
+    void enqueueStartingNodes(NodeQueue &queue);
+    Node* startingNode(const Transition& transition, double& cost);
+    Node* successor(Node* current_node, const Transition& next_transition, double& cost);
 
     void generatePathCandidate(Node* current_node);
     void generatePath(const std::deque<const Node *> &path_transitions, PathBuilder &path_builder) const;
@@ -55,6 +95,8 @@ private:
 
     void updateDynamicParameters();
 
+    void checkCancelled() const;
+
 private:
     ros::NodeHandle pnh_;
 
@@ -75,11 +117,17 @@ private:
     double max_distance_for_direct_try;
     double max_time_for_direct_try;
 
+    std::function<void()> check_cancelled_;
+
     path_msgs::PathSequence start_appendix;
     path_msgs::PathSequence end_appendix;
 
-    // search parameters
-    std::map<const Transition*, Node> nodes;
+    // search parameters, nodes are indexed by TransitionTable::state and reused between searches
+    std::vector<Node> nodes;
+    NodeQueue priority_queue;
+
+    TransitionTable::ConstPtr transition_table_;
+    std::unique_ptr<ResultCache> result_cache_;
 
     const Segment* start_segment;
     const Segment* end_segment;
@@ -88,6 +136,7 @@ private:
 
     double min_cost;
     path_msgs::PathSequence best_path;
+    ResultCache::Chain best_chain;
 };
 
 #endif // SEARCH_H
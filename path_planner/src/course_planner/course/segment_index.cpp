@@ -0,0 +1,73 @@
+#include "segment_index.h"
+
+#include "segment.h"
+
+namespace
+{
+double distanceToSegment(const Eigen::Vector2d& pt, const Eigen::Vector2d& a, const Eigen::Vector2d& b)
+{
+    Eigen::Vector2d ab = b - a;
+    double len2 = ab.squaredNorm();
+    double t = len2 > 0.0 ? std::max(0.0, std::min(1.0, (pt - a).dot(ab) / len2)) : 0.0;
+    return (a + t * ab - pt).norm();
+}
+}
+
+SegmentIndex::SegmentIndex()
+    : cell_size_(1.0), origin_(0, 0), width_(0), height_(0)
+{
+}
+
+void SegmentIndex::build(const std::vector<Segment>& segments, double cell_size)
+{
+    cell_size_ = cell_size;
+    offsets_.clear();
+    entries_.clear();
+    width_ = 0;
+    height_ = 0;
+
+    if(segments.empty()) {
+        return;
+    }
+
+    Eigen::Vector2d min = segments.front().line.startPoint();
+    Eigen::Vector2d max = min;
+    for(const Segment& s : segments) {
+        min = min.cwiseMin(s.line.startPoint()).cwiseMin(s.line.endPoint());
+        max = max.cwiseMax(s.line.startPoint()).cwiseMax(s.line.endPoint());
+    }
+
+    origin_ = min;
+    width_ = (int) std::floor((max(0) - min(0)) / cell_size_) + 1;
+    height_ = (int) std::floor((max(1) - min(1)) / cell_size_) + 1;
+
+    // a segment passes through a cell only if it is within half a diagonal of the cell center
+    const double reach = 0.5 * std::sqrt(2.0) * cell_size_;
+
+    std::vector<std::vector<std::size_t>> cells(width_ * height_);
+    for(std::size_t index = 0; index < segments.size(); ++index) {
+        const Eigen::Vector2d& a = segments[index].line.startPoint();
+        const Eigen::Vector2d& b = segments[index].line.endPoint();
+
+        int x0 = (int) std::floor((std::min(a(0), b(0)) - origin_(0)) / cell_size_);
+        int y0 = (int) std::floor((std::min(a(1), b(1)) - origin_(1)) / cell_size_);
+        int x1 = (int) std::floor((std::max(a(0), b(0)) - origin_(0)) / cell_size_);
+        int y1 = (int) std::floor((std::max(a(1), b(1)) - origin_(1)) / cell_size_);
+
+        for(int y = y0; y <= y1; ++y) {
+            for(int x = x0; x <= x1; ++x) {
+                Eigen::Vector2d center = origin_ + Eigen::Vector2d(x + 0.5, y + 0.5) * cell_size_;
+                if(distanceToSegment(center, a, b) <= reach) {
+                    cells[y * width_ + x].push_back(index);
+                }
+            }
+        }
+    }
+
+    offsets_.reserve(cells.size() + 1);
+    offsets_.push_back(0);
+    for(const std::vector<std::size_t>& cell : cells) {
+        entries_.insert(entries_.end(), cell.begin(), cell.end());
+        offsets_.push_back(entries_.size());
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef SEGMENT_INDEX_H
+#define SEGMENT_INDEX_H
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+class Segment;
+
+/**
+ * @brief The SegmentIndex class is a uniform grid over the segments of a course map.
+ *        Each cell lists the segments passing through it, in increasing index order.
+ */
+class SegmentIndex
+{
+public:
+    SegmentIndex();
+
+    void build(const std::vector<Segment>& segments, double cell_size);
+
+    /**
+     * @brief forEachCandidate calls fn(index) for every segment that may be closer than radius to pt.
+     *        A segment may be reported more than once.
+     */
+    template <typename Callback>
+    void forEachCandidate(const Eigen::Vector2d& pt, double radius, Callback fn) const
+    {
+        if(width_ == 0 || height_ == 0) {
+            return;
+        }
+
+        int x0 = std::max(0, (int) std::floor((pt(0) - radius - origin_(0)) / cell_size_));
+        int y0 = std::max(0, (int) std::floor((pt(1) - radius - origin_(1)) / cell_size_));
+        int x1 = std::min(width_ - 1, (int) std::floor((pt(0) + radius - origin_(0)) / cell_size_));
+        int y1 = std::min(height_ - 1, (int) std::floor((pt(1) + radius - origin_(1)) / cell_size_));
+
+        for(int y = y0; y <= y1; ++y) {
+            for(int x = x0; x <= x1; ++x) {
+                std::size_t cell = y * width_ + x;
+                for(std::size_t i = offsets_[cell], end = offsets_[cell + 1]; i < end; ++i) {
+                    fn(entries_[i]);
+                }
+            }
+        }
+    }
+
+private:
+    double cell_size_;
+    Eigen::Vector2d origin_;
+    int width_;
+    int height_;
+
+    // segment indices of cell c are entries_[offsets_[c] .. offsets_[c+1])
+    std::vector<std::size_t> offsets_;
+    std::vector<std::size_t> entries_;
+};
+
+#endif // SEGMENT_INDEX_H
@@ -10,6 +10,9 @@ class Transition {
 public:
     double arc_length() const;
 
+    // index in [0, CourseMap::getTransitionCount())
+    std::size_t id;
+
     const Segment* source;
     const Segment* target;
 
@@ -0,0 +1,265 @@
+#include "transition_table.h"
+
+#include <ros/console.h>
+#include <boost/thread.hpp>
+#include <atomic>
+#include <fstream>
+#include <limits>
+#include <queue>
+
+#include "course_map.h"
+#include "segment.h"
+#include "transition.h"
+
+namespace
+{
+const uint32_t FILE_MAGIC = 0x31545443; // "CTT1"
+
+class Hash
+{
+public:
+    Hash()
+        : value(14695981039346656037ull)
+    {}
+
+    template <typename T>
+    void add(const T& v)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&v);
+        for(std::size_t i = 0; i < sizeof(T); ++i) {
+            value ^= bytes[i];
+            value *= 1099511628211ull;
+        }
+    }
+
+    void add(const Eigen::Vector2d& v)
+    {
+        add(v(0));
+        add(v(1));
+    }
+
+    uint64_t value;
+};
+}
+
+TransitionTable::TransitionTable(const CourseMap& course, const Costs& costs)
+    : course_(course),
+      costs_(costs),
+      transitions_(course.getTransitionCount()),
+      states_(2 * transitions_),
+      transition_(transitions_, nullptr),
+      curve_forward_(transitions_, true),
+      edges_(transitions_),
+      arrivals_(course.getSegments().size())
+{
+    const std::vector<Segment>& segments = course.getSegments();
+    const Segment* first = segments.data();
+
+    std::vector<const Segment*> next_segment(transitions_, nullptr);
+    for(const Segment& s : segments) {
+        for(const Transition& t : s.forward_transitions) {
+            transition_[t.id] = &t;
+            curve_forward_[t.id] = true;
+            next_segment[t.id] = t.target;
+        }
+        for(const Transition& t : s.backward_transitions) {
+            transition_[t.id] = &t;
+            curve_forward_[t.id] = false;
+            next_segment[t.id] = t.source;
+        }
+    }
+
+    for(std::size_t id = 0; id < transitions_; ++id) {
+        const Transition* t = transition_[id];
+        const Segment* segment = next_segment[id];
+        arrivals_[segment - first].push_back(id);
+
+        double curve_cost = CostCalculator::curveCost(costs_, *t, curve_forward_[id]);
+
+        Eigen::Vector2d start = curve_forward_[id] ? t->path.back() : t->path.front();
+        for(int i = 0; i <= 1; ++i) {
+            const auto& next_transitions = i == 0 ? segment->forward_transitions : segment->backward_transitions;
+            for(const Transition& next : next_transitions) {
+                Edge edge;
+                edge.to = next.id;
+
+                Eigen::Vector2d end = curveStart(next.id);
+                edge.segment_forward = CostCalculator::isSegmentForward(segment, start, end);
+                edge.cost = curve_cost + CostCalculator::straightCost(costs_, (end - start).norm(), edge.segment_forward);
+
+                edges_[id].push_back(edge);
+            }
+        }
+    }
+}
+
+TransitionTable::Ptr TransitionTable::build(const CourseMap& course, const Costs& costs, std::size_t max_transitions, int threads)
+{
+    if(course.getTransitionCount() > max_transitions) {
+        ROS_WARN_STREAM("course has " << course.getTransitionCount() << " transitions, not precomputing more than "
+                        << max_transitions);
+        return nullptr;
+    }
+
+    Ptr table(new TransitionTable(course, costs));
+    table->table_.assign(table->states_ * table->states_, std::numeric_limits<float>::infinity());
+
+    if(threads <= 0) {
+        threads = std::max(1u, boost::thread::hardware_concurrency());
+    }
+
+    std::atomic<std::size_t> next_row(0);
+    auto worker = [&table, &next_row]() {
+        for(std::size_t row = next_row++; row < table->states_; row = next_row++) {
+            table->computeRow(row);
+        }
+    };
+
+    boost::thread_group group;
+    for(int i = 0; i < threads; ++i) {
+        group.create_thread(worker);
+    }
+    group.join_all();
+
+    return table;
+}
+
+void TransitionTable::computeRow(std::size_t source)
+{
+    typedef std::pair<double, std::size_t> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+
+    std::vector<double> dist(states_, std::numeric_limits<double>::infinity());
+    dist[source] = 0.0;
+    queue.push(Entry(0.0, source));
+
+    while(!queue.empty()) {
+        Entry entry = queue.top();
+        queue.pop();
+
+        std::size_t current = entry.second;
+        if(entry.first > dist[current]) {
+            continue;
+        }
+
+        for(const Edge& edge : edges_[current / 2]) {
+            std::size_t neighbor = state(edge.to, edge.segment_forward);
+            double new_cost = entry.first + edgeCost(current, edge);
+            if(new_cost < dist[neighbor]) {
+                dist[neighbor] = new_cost;
+                queue.push(Entry(new_cost, neighbor));
+            }
+        }
+    }
+
+    float* row = &table_[source * states_];
+    for(std::size_t i = 0; i < states_; ++i) {
+        row[i] = dist[i];
+    }
+}
+
+double TransitionTable::edgeCost(std::size_t from_state, const Edge& edge) const
+{
+    bool previous_forward = from_state % 2 == 1;
+    bool curve_forward = curve_forward_[from_state / 2];
+
+    return edge.cost + CostCalculator::turningCost(costs_, previous_forward, edge.segment_forward, curve_forward);
+}
+
+bool TransitionTable::next(std::size_t from, std::size_t to, std::size_t& next) const
+{
+    double best = std::numeric_limits<double>::infinity();
+    for(const Edge& edge : edges_[from / 2]) {
+        std::size_t neighbor = state(edge.to, edge.segment_forward);
+        double c = edgeCost(from, edge) + cost(neighbor, to);
+        if(c < best) {
+            best = c;
+            next = neighbor;
+        }
+    }
+    return best < std::numeric_limits<double>::infinity();
+}
+
+const std::vector<std::size_t>& TransitionTable::arrivals(const Segment* segment) const
+{
+    return arrivals_[segment - course_.getSegments().data()];
+}
+
+const Eigen::Vector2d& TransitionTable::curveStart(std::size_t transition) const
+{
+    const Transition* t = transition_[transition];
+    return curve_forward_[transition] ? t->path.front() : t->path.back();
+}
+
+uint64_t TransitionTable::hash() const
+{
+    Hash hash;
+    hash.add(costs_.backward_penalty_factor);
+    hash.add(costs_.turning_straight_segment);
+    hash.add(costs_.turning_penalty);
+
+    for(const Segment& s : course_.getSegments()) {
+        hash.add(s.line.startPoint());
+        hash.add(s.line.endPoint());
+    }
+
+    hash.add(transitions_);
+    for(std::size_t id = 0; id < transitions_; ++id) {
+        const Transition* t = transition_[id];
+        hash.add(curve_forward_[id] ? 1 : 0);
+        hash.add(t->arc_length());
+        hash.add(t->path.front());
+        hash.add(t->path.back());
+        hash.add(edges_[id].size());
+    }
+
+    return hash.value;
+}
+
+bool TransitionTable::save(const std::string& file) const
+{
+    std::ofstream out(file, std::ios::binary);
+    if(!out) {
+        ROS_ERROR_STREAM("cannot write transition table to " << file);
+        return false;
+    }
+
+    uint64_t h = hash();
+    uint64_t states = states_;
+    out.write(reinterpret_cast<const char*>(&FILE_MAGIC), sizeof(FILE_MAGIC));
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(&states), sizeof(states));
+    out.write(reinterpret_cast<const char*>(table_.data()), table_.size() * sizeof(float));
+
+    return out.good();
+}
+
+TransitionTable::Ptr TransitionTable::load(const std::string& file, const CourseMap& course, const Costs& costs)
+{
+    std::ifstream in(file, std::ios::binary);
+    if(!in) {
+        return nullptr;
+    }
+
+    uint32_t magic = 0;
+    uint64_t h = 0;
+    uint64_t states = 0;
+    in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    in.read(reinterpret_cast<char*>(&h), sizeof(h));
+    in.read(reinterpret_cast<char*>(&states), sizeof(states));
+
+    Ptr table(new TransitionTable(course, costs));
+    if(!in || magic != FILE_MAGIC || states != table->states_ || h != table->hash()) {
+        ROS_WARN_STREAM("transition table " << file << " does not match the course, recomputing it");
+        return nullptr;
+    }
+
+    table->table_.resize(table->states_ * table->states_);
+    in.read(reinterpret_cast<char*>(table->table_.data()), table->table_.size() * sizeof(float));
+    if(!in) {
+        ROS_WARN_STREAM("transition table " << file << " is truncated, recomputing it");
+        return nullptr;
+    }
+
+    return table;
+}
@@ -0,0 +1,112 @@
+#ifndef TRANSITION_TABLE_H
+#define TRANSITION_TABLE_H
+
+#include <Eigen/Core>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cost_calculator.h"
+
+class CourseMap;
+class Segment;
+class Transition;
+
+/**
+ * @brief The TransitionTable class stores the cost between all pairs of search states of a course map.
+ *
+ * The cost of leaving a transition depends on the direction the previous segment was traversed in
+ * (turning penalties), so a state is a transition combined with that direction.
+ * States are numbered like the nodes of Search, edges are priced with the cost model of CostCalculator.
+ * The cost of a state is measured like Node::cost: from the start of its curve on the previous segment.
+ */
+class TransitionTable
+{
+public:
+    typedef std::shared_ptr<TransitionTable> Ptr;
+    typedef std::shared_ptr<const TransitionTable> ConstPtr;
+
+    typedef CostCalculator::Costs Costs;
+
+public:
+    /**
+     * @brief build computes the table with one Dijkstra search per state
+     * @return nullptr, if the course has more than max_transitions transitions
+     */
+    static Ptr build(const CourseMap& course, const Costs& costs, std::size_t max_transitions, int threads);
+
+    /**
+     * @brief load reads a table written by save, if it was computed for the same course and costs
+     */
+    static Ptr load(const std::string& file, const CourseMap& course, const Costs& costs);
+    bool save(const std::string& file) const;
+
+    static std::size_t state(std::size_t transition, bool segment_forward)
+    {
+        return 2 * transition + (segment_forward ? 1 : 0);
+    }
+
+    std::size_t stateCount() const
+    {
+        return states_;
+    }
+
+    /**
+     * @brief cost of the cheapest path from state from to state to, infinity if there is none
+     */
+    float cost(std::size_t from, std::size_t to) const
+    {
+        return table_[from * states_ + to];
+    }
+
+    /**
+     * @brief next finds the first state after from on the cheapest path to state to
+     * @return false, if to is not reachable
+     */
+    bool next(std::size_t from, std::size_t to, std::size_t& next) const;
+
+    /**
+     * @brief arrivals returns the ids of all transitions leading onto segment
+     */
+    const std::vector<std::size_t>& arrivals(const Segment* segment) const;
+
+    /**
+     * @brief curveStart is the point where the curve of the transition leaves the previous segment
+     */
+    const Eigen::Vector2d& curveStart(std::size_t transition) const;
+
+private:
+    struct Edge
+    {
+        std::size_t to;
+        // curve cost of the source transition + straight cost, without the turning cost
+        double cost;
+        bool segment_forward;
+    };
+
+    TransitionTable(const CourseMap& course, const Costs& costs);
+
+    void computeRow(std::size_t source);
+    double edgeCost(std::size_t from_state, const Edge& edge) const;
+    uint64_t hash() const;
+
+private:
+    const CourseMap& course_;
+    Costs costs_;
+
+    std::size_t transitions_;
+    std::size_t states_;
+
+    // per transition, indexed by Transition::id
+    std::vector<const Transition*> transition_;
+    std::vector<bool> curve_forward_;
+    std::vector<std::vector<Edge>> edges_;
+
+    // per segment
+    std::vector<std::vector<std::size_t>> arrivals_;
+
+    std::vector<float> table_;
+};
+
+#endif // TRANSITION_TABLE_H
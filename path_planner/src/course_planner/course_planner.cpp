@@ -35,6 +35,7 @@ CoursePlanner::CoursePlanner()
     pnh.param("course/map_segments", map_segment_array_, map_segment_array_);
 
     course_.load(map_segment_array_);
+    course_search_.loadTransitionTable();
 }
 
 void CoursePlanner::tick()
@@ -161,7 +162,7 @@ path_msgs::PathSequence CoursePlanner::plan (const path_msgs::PlanPathGoal &goal
     path_geom::PathPose from_world_p(from_world.x, from_world.y, from_world.theta);
     path_geom::PathPose to_world_p(to_world.x, to_world.y, to_world.theta);
 
-    auto res = course_search_.findPath(map_info, goal, from_world_p, to_world_p);
+    auto res = course_search_.findPath(map_info, goal, from_world_p, to_world_p, [this]() { checkCancelled(); });
     res.header = goal.goal.pose.header;
 
     return res;
@@ -108,7 +108,10 @@ struct GoalPathPlanner : public Planner
 
 
 
-        path_ = postprocess(path_raw);
+        {
+            boost::lock_guard<boost::mutex> request_lock(request_mutex_);
+            path_ = postprocess(path_raw);
+        }
 
         publish(path_, path_raw);
         for(const path_msgs::DirectionalPath& path : path_raw.paths) {
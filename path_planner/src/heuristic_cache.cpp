@@ -0,0 +1,311 @@
+/// HEADER
+#include "heuristic_cache.h"
+
+/// SYSTEM
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace {
+const float INF = std::numeric_limits<float>::infinity();
+
+typedef std::pair<float, int> QueueEntry;
+typedef std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> Queue;
+
+bool isTraversable(uint8_t value, uint8_t obstacle_threshold)
+{
+    return value < obstacle_threshold || value == 255;
+}
+
+/// 8-connected Dijkstra wavefront, continues from the queued cells
+void propagate(const HeuristicCache::Grid& grid, std::vector<float>& cost, Queue& queue)
+{
+    static const int dx[] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+    static const int dy[] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+    static const float step[] = { 1.f, 1.f, 1.f, 1.f, (float) M_SQRT2, (float) M_SQRT2, (float) M_SQRT2, (float) M_SQRT2 };
+
+    const TiledGrid<uint8_t>& data = *grid.data;
+    const int w = grid.width;
+    const int h = grid.height;
+
+    while(!queue.empty()) {
+        QueueEntry top = queue.top();
+        queue.pop();
+
+        int idx = top.second;
+        if(top.first > cost[idx]) {
+            continue;
+        }
+
+        int x = idx % w;
+        int y = idx / w;
+        for(int n = 0; n < 8; ++n) {
+            int nx = x + dx[n];
+            int ny = y + dy[n];
+            if(nx < 0 || nx >= w || ny < 0 || ny >= h) {
+                continue;
+            }
+            int nidx = ny * w + nx;
+            if(!isTraversable(data.at(nx, ny), grid.obstacle_threshold)) {
+                continue;
+            }
+            float c = top.first + step[n];
+            if(c < cost[nidx]) {
+                cost[nidx] = c;
+                queue.push(QueueEntry(c, nidx));
+            }
+        }
+    }
+}
+}
+
+HeuristicCache::Grid::Grid()
+    : width(0), height(0), obstacle_threshold(255), revision(0),
+      changed_x0(0), changed_y0(0), changed_x1(0), changed_y1(0)
+{
+
+}
+
+float HeuristicCache::Field::at(int x, int y) const
+{
+    if(x < 0 || x >= width || y < 0 || y >= height) {
+        return INF;
+    }
+    return cost[y * width + x];
+}
+
+bool HeuristicCache::Field::isBlocked(int x, int y) const
+{
+    if(x < 0 || x >= width || y < 0 || y >= height) {
+        return true;
+    }
+    return !isTraversable(data->at(x, y), obstacle_threshold);
+}
+
+HeuristicCache::HeuristicCache(std::size_t max_fields)
+    : max_fields_(max_fields), shutdown_(false), has_grid_(false), grid_changed_(false)
+{
+    worker_ = boost::thread(boost::bind(&HeuristicCache::run, this));
+}
+
+HeuristicCache::~HeuristicCache()
+{
+    {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    work_available_.notify_all();
+    worker_.join();
+}
+
+void HeuristicCache::setGrid(const Grid &grid)
+{
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    if(has_grid_ && grid.revision == grid_.revision) {
+        return;
+    }
+
+    // changes accumulate, if the worker has not processed the last version yet
+    if(grid_changed_ && grid.width == grid_.width && grid.height == grid_.height) {
+        Grid merged = grid;
+        merged.changed_x0 = std::min(grid.changed_x0, grid_.changed_x0);
+        merged.changed_y0 = std::min(grid.changed_y0, grid_.changed_y0);
+        merged.changed_x1 = std::max(grid.changed_x1, grid_.changed_x1);
+        merged.changed_y1 = std::max(grid.changed_y1, grid_.changed_y1);
+        grid_ = merged;
+    } else {
+        grid_ = grid;
+    }
+
+    has_grid_ = true;
+    grid_changed_ = true;
+    work_available_.notify_one();
+}
+
+void HeuristicCache::prefetch(int goal_x, int goal_y)
+{
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    prefetch_.push_back(Key(goal_x, goal_y));
+    work_available_.notify_one();
+}
+
+HeuristicCache::Field::ConstPtr HeuristicCache::get(int goal_x, int goal_y, std::size_t revision)
+{
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    if(!has_grid_) {
+        return nullptr;
+    }
+
+    Key key(goal_x, goal_y);
+    Field::ConstPtr field = find(key, revision);
+    if(!field && std::find(prefetch_.begin(), prefetch_.end(), key) == prefetch_.end()) {
+        // never block the caller with a full wavefront, the next request for this goal will find it
+        prefetch_.push_back(key);
+        work_available_.notify_one();
+    }
+    return field;
+}
+
+HeuristicCache::Field::ConstPtr HeuristicCache::find(const Key &key, std::size_t revision)
+{
+    auto pos = fields_.find(key);
+    if(pos == fields_.end() || pos->second->revision != revision) {
+        return nullptr;
+    }
+
+    lru_.remove(key);
+    lru_.push_front(key);
+    return pos->second;
+}
+
+void HeuristicCache::insert(const Field::ConstPtr &field)
+{
+    if(has_grid_ && field->revision != grid_.revision) {
+        // the map has changed in the meantime
+        return;
+    }
+
+    Key key(field->goal_x, field->goal_y);
+    fields_[key] = field;
+
+    lru_.remove(key);
+    lru_.push_front(key);
+
+    while(lru_.size() > max_fields_) {
+        fields_.erase(lru_.back());
+        lru_.pop_back();
+    }
+}
+
+void HeuristicCache::run()
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+
+    while(true) {
+        while(!shutdown_ && !grid_changed_ && prefetch_.empty()) {
+            work_available_.wait(lock);
+        }
+        if(shutdown_) {
+            return;
+        }
+
+        Grid grid = grid_;
+
+        if(grid_changed_) {
+            grid_changed_ = false;
+
+            std::vector<Field::ConstPtr> fields;
+            for(const auto& entry : fields_) {
+                fields.push_back(entry.second);
+            }
+
+            lock.unlock();
+            std::vector<Field::ConstPtr> updated;
+            for(const Field::ConstPtr& field : fields) {
+                updated.push_back(repair(grid, *field));
+            }
+            lock.lock();
+
+            for(const Field::ConstPtr& field : updated) {
+                insert(field);
+            }
+
+        } else {
+            Key key = prefetch_.front();
+            prefetch_.pop_front();
+
+            if(find(key, grid.revision)) {
+                continue;
+            }
+            if(key.first < 0 || key.first >= grid.width || key.second < 0 || key.second >= grid.height) {
+                continue;
+            }
+
+            lock.unlock();
+            Field::ConstPtr field = build(grid, key.first, key.second);
+            lock.lock();
+
+            insert(field);
+        }
+    }
+}
+
+HeuristicCache::Field::ConstPtr HeuristicCache::build(const Grid &grid, int goal_x, int goal_y)
+{
+    std::shared_ptr<Field> field(new Field);
+    field->goal_x = goal_x;
+    field->goal_y = goal_y;
+    field->width = grid.width;
+    field->height = grid.height;
+    field->revision = grid.revision;
+    field->data = grid.data;
+    field->obstacle_threshold = grid.obstacle_threshold;
+    field->cost.assign(grid.width * grid.height, INF);
+
+    int goal = goal_y * grid.width + goal_x;
+    field->cost[goal] = 0.f;
+
+    Queue queue;
+    queue.push(QueueEntry(0.f, goal));
+    propagate(grid, field->cost, queue);
+
+    return field;
+}
+
+HeuristicCache::Field::ConstPtr HeuristicCache::repair(const Grid &grid, const Field &old)
+{
+    if(old.revision + 1 != grid.revision || old.width != grid.width || old.height != grid.height) {
+        return build(grid, old.goal_x, old.goal_y);
+    }
+
+    const int w = grid.width;
+    const int h = grid.height;
+
+    /// every cell cheaper than the changed region (and its border) keeps its shortest path
+    int x0 = std::max(0, grid.changed_x0 - 1);
+    int y0 = std::max(0, grid.changed_y0 - 1);
+    int x1 = std::min(w, grid.changed_x1 + 1);
+    int y1 = std::min(h, grid.changed_y1 + 1);
+
+    float threshold = INF;
+    for(int y = y0; y < y1; ++y) {
+        for(int x = x0; x < x1; ++x) {
+            threshold = std::min(threshold, old.cost[y * w + x]);
+        }
+    }
+
+    std::shared_ptr<Field> field(new Field(old));
+    field->revision = grid.revision;
+    field->data = grid.data;
+    field->obstacle_threshold = grid.obstacle_threshold;
+
+    if(threshold == INF) {
+        // the changed region was not reachable and cannot connect to the reachable cells
+        return field;
+    }
+
+    std::vector<float>& cost = field->cost;
+    for(float& c : cost) {
+        if(c >= threshold) {
+            c = INF;
+        }
+    }
+
+    // continue the wavefront from the border of the kept cells
+    Queue queue;
+    for(int idx = 0, n = w * h; idx < n; ++idx) {
+        if(cost[idx] != INF && cost[idx] >= threshold - 1.5f) {
+            queue.push(QueueEntry(cost[idx], idx));
+        }
+    }
+    int goal = old.goal_y * w + old.goal_x;
+    if(cost[goal] == INF) {
+        cost[goal] = 0.f;
+        queue.push(QueueEntry(0.f, goal));
+    }
+    propagate(grid, cost, queue);
+
+    return field;
+}
@@ -0,0 +1,117 @@
+#ifndef HEURISTIC_CACHE_H
+#define HEURISTIC_CACHE_H
+
+/// SYSTEM
+#include <boost/thread.hpp>
+#include <stdint.h>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+/// PROJECT
+#include "tiled_grid.h"
+
+/**
+ * @brief The HeuristicCache class keeps holonomic cost-to-go fields (2D Dijkstra with obstacles)
+ *        for recently used goal cells. Fields are built and updated on a background thread.
+ *
+ * When the map changes, a field is only recomputed where the change can have an effect:
+ * all cells that are closer to the goal than the changed region keep their cost.
+ */
+class HeuristicCache
+{
+public:
+    /**
+     * @brief The Grid struct is the map version the fields are computed on
+     */
+    struct Grid
+    {
+        Grid();
+
+        std::shared_ptr<const TiledGrid<uint8_t>> data;
+        int width;
+        int height;
+
+        // cells with a value in [obstacle_threshold, 255) are not traversable
+        uint8_t obstacle_threshold;
+
+        std::size_t revision;
+
+        // rectangle [x0, x1) x [y0, y1) that changed since the previous revision
+        int changed_x0, changed_y0, changed_x1, changed_y1;
+    };
+
+    /**
+     * @brief The Field struct contains the cost-to-go in cells for every cell, infinity if unreachable
+     */
+    struct Field
+    {
+        typedef std::shared_ptr<const Field> ConstPtr;
+
+        float at(int x, int y) const;
+        bool isBlocked(int x, int y) const;
+
+        // grid the field has been computed on
+        std::shared_ptr<const TiledGrid<uint8_t>> data;
+        uint8_t obstacle_threshold;
+
+        int goal_x;
+        int goal_y;
+        int width;
+        int height;
+        std::size_t revision;
+        std::vector<float> cost;
+    };
+
+public:
+    HeuristicCache(std::size_t max_fields = 4);
+    ~HeuristicCache();
+
+    /**
+     * @brief setGrid sets a new map version, cached fields are updated in the background
+     */
+    void setGrid(const Grid& grid);
+
+    /**
+     * @brief prefetch builds the field for the given goal in the background
+     */
+    void prefetch(int goal_x, int goal_y);
+
+    /**
+     * @brief get returns the field for the given goal on the given map version
+     * @param revision Grid::revision of the map the caller plans on
+     * @return nullptr, if the field is not available for this version. It is then built in the background.
+     */
+    Field::ConstPtr get(int goal_x, int goal_y, std::size_t revision);
+
+private:
+    typedef std::pair<int, int> Key;
+
+    void run();
+
+    void insert(const Field::ConstPtr& field);
+    Field::ConstPtr find(const Key& key, std::size_t revision);
+
+    static Field::ConstPtr build(const Grid& grid, int goal_x, int goal_y);
+    static Field::ConstPtr repair(const Grid& grid, const Field& old);
+
+private:
+    std::size_t max_fields_;
+
+    boost::mutex mutex_;
+    boost::condition_variable work_available_;
+    boost::thread worker_;
+    bool shutdown_;
+
+    Grid grid_;
+    bool has_grid_;
+    bool grid_changed_;
+    std::deque<Key> prefetch_;
+
+    std::map<Key, Field::ConstPtr> fields_;
+    std::list<Key> lru_;
+};
+
+#endif // HEURISTIC_CACHE_H
@@ -22,6 +22,9 @@
 /// SYSTEM
 #include <nav_msgs/Path.h>
 #include <nav_msgs/GridCells.h>
+#include <cmath>
+#include <limits>
+#include <sstream>
 
 using namespace lib_path;
 
@@ -254,7 +257,7 @@ struct PathPlanner : public Planner
     };
 
     PathPlanner()
-        : render_open_cells_(false)
+        : portfolio_first_(true), has_generic_options_(false), render_open_cells_(false)
     {
         nh_priv.param("render_open_cells", render_open_cells_, false);
 
@@ -278,6 +281,8 @@ struct PathPlanner : public Planner
         if(render_open_cells_) {
             cell_publisher_ = nh_priv.advertise<nav_msgs::GridCells>("cells", 1, true);
         }
+
+        loadPortfolio();
     }
 
     virtual bool supportsGoalType(int type) const override
@@ -419,7 +424,7 @@ struct PathPlanner : public Planner
                                           const lib_path::Pose2d& from_world, const lib_path::Pose2d& to_world,
                                           const lib_path::Pose2d& from_map, const lib_path::Pose2d& to_map) {
 
-        initSearch(algo, request.goal.pose.header, request.options.max_search_duration);
+        initSearch(algo, request.goal.pose.header, searchTimeLimit(request));
 
         try {
             typename Algorithm::PathT path;
@@ -430,15 +435,13 @@ struct PathPlanner : public Planner
                 return false;
             });
 
-            if(render_open_cells_) {
-                path = algo.findPath(from_map, to_map,
-                                     boost::bind(&PathPlanner::renderCells, this, algo_id),
-                                     search_options);
+            path = algo.findPath(from_map, to_map,
+                                 boost::bind(&PathPlanner::searchCallback, this, algo_id),
+                                 search_options);
 
+            if(render_open_cells_) {
                 // render cells once more -> remove the last ones
                 renderCells(algo_id);
-            } else {
-                path = algo.findPath(from_map, to_map, search_options);
             }
 
             int id = 1;
@@ -460,7 +463,7 @@ struct PathPlanner : public Planner
                                              const path_msgs::PlanPathGoal &request,
                                              const Pose2d &from_world, const Pose2d &from_map) {
 
-        initSearch(algo, request.goal.map.header, request.options.max_search_duration);
+        initSearch(algo, request.goal.map.header, searchTimeLimit(request));
 
         try {
             typename Algorithm::PathT path;
@@ -478,15 +481,13 @@ struct PathPlanner : public Planner
                 goal_test.setHeuristicGoal(goal);
             }
 
-            if(render_open_cells_) {
-                path = algo.findPath(from_map, goal_test,
-                                     boost::bind(&PathPlanner::renderCells, this, algo_id),
-                                     search_options);
+            path = algo.findPath(from_map, goal_test,
+                                 boost::bind(&PathPlanner::searchCallback, this, algo_id),
+                                 search_options);
 
+            if(render_open_cells_) {
                 // render cells once more -> remove the last ones
                 renderCells(algo_id);
-            } else {
-                path = algo.findPath(from_map, goal_test, search_options);
             }
 
             int id = 1;
@@ -535,11 +536,19 @@ struct PathPlanner : public Planner
     path_msgs::PathSequence plan (const path_msgs::PlanPathGoal &goal,
                                   const lib_path::Pose2d& from_world, const lib_path::Pose2d& to_world,
                                   const lib_path::Pose2d& from_map, const lib_path::Pose2d& to_map) {
+        // the static map alone separates start and goal -> no kinematic search can succeed
+        if(isSeparatedOnStaticMap(from_map, to_map)) {
+            return empty();
+        }
+
         Algo algorithm = algo_to_use;
 
         if(!goal.goal.planning_algorithm.data.empty()) {
             ROS_INFO_STREAM("planning w/ target pose with requested algorithm: " << goal.goal.planning_algorithm.data);
             algorithm = stringToAlgorithm(goal.goal.planning_algorithm.data);
+
+        } else if(!portfolio_.empty()) {
+            return planPortfolio(goal, from_map, to_map);
         }
 
         switch(algorithm) {
@@ -585,8 +594,335 @@ struct PathPlanner : public Planner
         DynamicSteeringNeighborhood::STEER_DELTA = goal.options.ackermann_steer_delta_degree;
         DynamicSteeringNeighborhood::steer_steps = goal.options.ackermann_steer_steps;
         DynamicSteeringNeighborhood::LA = goal.options.ackermann_la;
+
+        generic_options_ = goal.options;
+        has_generic_options_ = true;
+    }
+
+    bool hasGenericParameters(const path_msgs::PlannerOptions& options) const
+    {
+        return has_generic_options_ &&
+                generic_options_.goal_dist_threshold == options.goal_dist_threshold &&
+                generic_options_.goal_angle_threshold_degree == options.goal_angle_threshold_degree &&
+                generic_options_.reversed == options.reversed &&
+                generic_options_.allow_forward == options.allow_forward &&
+                generic_options_.allow_backward == options.allow_backward &&
+                generic_options_.ackermann_max_steer_angle_degree == options.ackermann_max_steer_angle_degree &&
+                generic_options_.ackermann_steer_delta_degree == options.ackermann_steer_delta_degree &&
+                generic_options_.ackermann_steer_steps == options.ackermann_steer_steps &&
+                generic_options_.ackermann_la == options.ackermann_la;
+    }
+
+    path_msgs::PathSequence planQuery(const path_msgs::PlanPathGoal &request) override
+    {
+        if(request.goal.type != path_msgs::Goal::GOAL_TYPE_POSE) {
+            // planWithoutTargetPose may reconfigure the generic neighborhood that concurrent pose queries read
+            boost::unique_lock<boost::shared_mutex> lock(generic_options_mutex_);
+            return Planner::planQuery(request);
+        }
+
+        lib_path::Pose2d from_world, from_map;
+        transformPose(request.use_start ? request.start : lookupPose(), from_world, from_map);
+        lib_path::Pose2d to_world, to_map;
+        transformPose(request.goal.pose, to_world, to_map);
+
+        if(isSeparatedOnStaticMap(from_map, to_map)) {
+            return empty();
+        }
+
+        Algo algorithm = algo_to_use;
+        if(!request.goal.planning_algorithm.data.empty()) {
+            algorithm = stringToAlgorithm(request.goal.planning_algorithm.data);
+        }
+
+        // every query owns its search, the map is shared read-only
+        std::shared_ptr<HypothesisBase> search = makeHypothesis(algorithm, "query", search_options);
+        CancellationToken token;
+
+        if(algorithm != Algo::GENERIC) {
+            return search->plan(*this, request, from_map, to_map, token);
+        }
+
+        // the generic neighborhood is configured statically, queries with the same options can share it
+        {
+            boost::shared_lock<boost::shared_mutex> lock(generic_options_mutex_);
+            if(hasGenericParameters(request.options)) {
+                return search->plan(*this, request, from_map, to_map, token);
+            }
+        }
+
+        boost::unique_lock<boost::shared_mutex> lock(generic_options_mutex_);
+        updateGenericParameters(request);
+        return search->plan(*this, request, from_map, to_map, token);
+    }
+
+    path_msgs::PathSequence planPreliminary(const path_msgs::PlanPathGoal &request) override
+    {
+        Algo algorithm = algo_to_use;
+        if(!request.goal.planning_algorithm.data.empty()) {
+            algorithm = stringToAlgorithm(request.goal.planning_algorithm.data);
+        }
+        if(request.goal.type != path_msgs::Goal::GOAL_TYPE_POSE || algorithm == Algo::OMNI) {
+            // the final path is found by the 2d search anyway
+            return empty();
+        }
+
+        lib_path::Pose2d from_world, from_map;
+        transformPose(request.use_start ? request.start : lookupPose(), from_world, from_map);
+        lib_path::Pose2d to_world, to_map;
+        transformPose(request.goal.pose, to_world, to_map);
+
+        if(isSeparatedOnStaticMap(from_map, to_map)) {
+            return empty();
+        }
+
+        std::shared_ptr<HypothesisBase> search = makeHypothesis(Algo::OMNI, "preliminary", search_options);
+        CancellationToken token;
+        return search->plan(*this, request, from_map, to_map, token);
+    }
+
+    bool isSeparatedOnStaticMap(const lib_path::Pose2d& from_map, const lib_path::Pose2d& to_map)
+    {
+        HeuristicCache::Field::ConstPtr heuristic = holonomicHeuristic(to_map);
+        if(heuristic && !heuristic->isBlocked(from_map.x, from_map.y) && std::isinf(heuristic->at(from_map.x, from_map.y))) {
+            ROS_WARN_STREAM("goal is not reachable from the start on the static map");
+            return true;
+        }
+        return false;
+    }
+
+
+    /**
+     * @brief The HypothesisBase struct is one search configuration of the planner portfolio
+     */
+    struct HypothesisBase
+    {
+        HypothesisBase(const std::string& name, const SearchOptions& options)
+            : name(name), options(options)
+        {}
+
+        virtual ~HypothesisBase()
+        {}
+
+        virtual path_msgs::PathSequence plan(PathPlanner& planner, const path_msgs::PlanPathGoal &request,
+                                             const lib_path::Pose2d& from_map, const lib_path::Pose2d& to_map,
+                                             const CancellationToken& token) = 0;
+
+        std::string name;
+        SearchOptions options;
+    };
+
+    template <typename Algorithm>
+    struct Hypothesis : public HypothesisBase
+    {
+        Hypothesis(const std::string& name, const SearchOptions& options)
+            : HypothesisBase(name, options)
+        {}
+
+        path_msgs::PathSequence plan(PathPlanner& planner, const path_msgs::PlanPathGoal &request,
+                                     const lib_path::Pose2d& from_map, const lib_path::Pose2d& to_map,
+                                     const CancellationToken& token) override
+        {
+            return planner.searchHypothesis(algo, request, from_map, to_map, this->options, token);
+        }
+
+        // every hypothesis owns its search, so they can run concurrently
+        Algorithm algo;
+    };
+
+    std::shared_ptr<HypothesisBase> makeHypothesis(Algo algo, const std::string& name, const SearchOptions& options) const
+    {
+        switch(algo) {
+        case Algo::ACKERMANN:
+            return std::make_shared<Hypothesis<AStarAckermann>>(name, options);
+        case Algo::SUMMIT:
+            return std::make_shared<Hypothesis<AStarSummit>>(name, options);
+        case Algo::PATSY:
+            return std::make_shared<Hypothesis<AStarPatsy>>(name, options);
+        case Algo::PATSY_FORWARD:
+            return std::make_shared<Hypothesis<AStarPatsyForward>>(name, options);
+        case Algo::SUMMIT_FORWARD:
+            return std::make_shared<Hypothesis<AStarSummitForward>>(name, options);
+        case Algo::OMNI:
+            return std::make_shared<Hypothesis<AStar2D>>(name, options);
+        case Algo::GENERIC:
+            return std::make_shared<Hypothesis<AStarSteeringDynamic>>(name, options);
+
+        default:
+            throw std::runtime_error("unknown algorithm selected");
+        }
+    }
+
+    static double readNumber(XmlRpc::XmlRpcValue& value)
+    {
+        if(value.getType() == XmlRpc::XmlRpcValue::TypeInt) {
+            return static_cast<int>(value);
+        }
+        return static_cast<double>(value);
+    }
+
+    void loadPortfolio()
+    {
+        std::string mode = nh_priv.param("portfolio/mode", std::string("first"));
+        portfolio_first_ = mode != "best";
+
+        XmlRpc::XmlRpcValue hypotheses;
+        if(!nh_priv.getParam("portfolio/hypotheses", hypotheses)) {
+            return;
+        }
+        if(hypotheses.getType() != XmlRpc::XmlRpcValue::TypeArray) {
+            ROS_ERROR("portfolio/hypotheses has to be a list, portfolio planning is disabled");
+            return;
+        }
+
+        for(int i = 0; i < hypotheses.size(); ++i) {
+            XmlRpc::XmlRpcValue& entry = hypotheses[i];
+
+            std::string algo = entry.hasMember("algorithm") ? static_cast<std::string>(entry["algorithm"]) : std::string("generic");
+            std::transform(algo.begin(), algo.end(), algo.begin(), ::tolower);
+
+            SearchOptions options = search_options;
+            if(entry.hasMember("penalty_backward")) {
+                options.penalty_backward = readNumber(entry["penalty_backward"]);
+            }
+            if(entry.hasMember("penalty_turn")) {
+                options.penalty_turn = readNumber(entry["penalty_turn"]);
+            }
+            if(entry.hasMember("oversearch_distance")) {
+                options.oversearch_distance = readNumber(entry["oversearch_distance"]);
+            }
+
+            std::stringstream name;
+            name << i << ": " << algo << " (backward " << options.penalty_backward << ", turn " << options.penalty_turn << ")";
+
+            portfolio_.push_back(makeHypothesis(stringToAlgorithm(algo), name.str(), options));
+            ROS_INFO_STREAM("portfolio hypothesis " << name.str());
+        }
+
+        ROS_INFO_STREAM("portfolio planning with " << portfolio_.size() << " hypotheses, mode: " << (portfolio_first_ ? "first" : "best"));
     }
 
+    template <typename Algorithm>
+    path_msgs::PathSequence searchHypothesis(Algorithm& algo, const path_msgs::PlanPathGoal &request,
+                                             const lib_path::Pose2d& from_map, const lib_path::Pose2d& to_map,
+                                             const SearchOptions& options, const CancellationToken& token)
+    {
+        // the map is shared read-only between all hypotheses
+        algo.setMap(map_info);
+        algo.setTimeLimit(searchTimeLimit(request));
+        if(use_cost_map_) {
+            algo.setCostFunction(true);
+        }
+
+        try {
+            typename Algorithm::PathT path = algo.findPath(from_map, to_map, [this, &token]() {
+                // stop when another hypothesis has won or the whole request is cancelled
+                token.check();
+                checkCancelled();
+            }, options);
+
+            return path2msg(path, request.goal.pose.header.stamp);
+        }
+        catch(const std::logic_error& e) {
+            ROS_WARN_STREAM("hypothesis found no path: " << e.what());
+        }
+
+        return empty();
+    }
+
+    double pathCost(const path_msgs::PathSequence& path) const
+    {
+        double cost = 0.0;
+        for(const path_msgs::DirectionalPath& segment : path.paths) {
+            double length = 0.0;
+            for(std::size_t i = 1; i < segment.poses.size(); ++i) {
+                const geometry_msgs::Point& a = segment.poses[i-1].pose.position;
+                const geometry_msgs::Point& b = segment.poses[i].pose.position;
+                length += std::hypot(b.x - a.x, b.y - a.y);
+            }
+            cost += segment.forward ? length : search_options.penalty_backward * length;
+        }
+        if(!path.paths.empty()) {
+            cost += search_options.penalty_turn * (path.paths.size() - 1);
+        }
+        return cost;
+    }
+
+    path_msgs::PathSequence planPortfolio(const path_msgs::PlanPathGoal &request,
+                                          const lib_path::Pose2d& from_map, const lib_path::Pose2d& to_map)
+    {
+        updateGenericParameters(request);
+
+        std::size_t n = portfolio_.size();
+
+        std::vector<CancellationToken::Ptr> tokens(n);
+        std::vector<path_msgs::PathSequence> results(n);
+        std::vector<std::size_t> finished;
+        bool has_path = false;
+        boost::mutex result_mutex;
+        boost::condition_variable result_available;
+
+        boost::thread_group threads;
+        for(std::size_t i = 0; i < n; ++i) {
+            tokens[i].reset(new CancellationToken);
+            threads.create_thread([&, i]() {
+                path_msgs::PathSequence path;
+                try {
+                    path = portfolio_[i]->plan(*this, request, from_map, to_map, *tokens[i]);
+                } catch(const PlanningCancelledException& e) {
+                    // another hypothesis won
+                } catch(const std::exception& e) {
+                    ROS_ERROR_STREAM("hypothesis " << portfolio_[i]->name << " failed: " << e.what());
+                }
+
+                boost::lock_guard<boost::mutex> lock(result_mutex);
+                results[i] = path;
+                finished.push_back(i);
+                has_path |= !path.paths.empty();
+                result_available.notify_all();
+            });
+        }
+
+        {
+            boost::unique_lock<boost::mutex> lock(result_mutex);
+            while(finished.size() < n && !(portfolio_first_ && has_path)) {
+                result_available.wait(lock);
+            }
+        }
+
+        // stop the remaining hypotheses, they all have to release the map before we return
+        for(const CancellationToken::Ptr& token : tokens) {
+            token->cancel();
+        }
+        threads.join_all();
+
+        checkCancelled();
+
+        int best = -1;
+        double best_cost = std::numeric_limits<double>::infinity();
+        for(std::size_t i : finished) {
+            if(results[i].paths.empty()) {
+                continue;
+            }
+            if(portfolio_first_) {
+                best = i;
+                break;
+            }
+            double cost = pathCost(results[i]);
+            if(cost < best_cost) {
+                best = i;
+                best_cost = cost;
+            }
+        }
+
+        if(best < 0) {
+            ROS_ERROR("no hypothesis of the portfolio found a path");
+            return empty();
+        }
+
+        ROS_INFO_STREAM("portfolio: using the path of hypothesis " << portfolio_[best]->name);
+        return results[best];
+    }
 
     template <class Algorithm>
     void renderCellsInstance(Algorithm& algo)
@@ -606,6 +942,16 @@ struct PathPlanner : public Planner
         }
     }
 
+    void searchCallback(Algo algo)
+    {
+        // unwinds the search with an exception, if it has been cancelled
+        checkCancelled();
+
+        if(render_open_cells_) {
+            renderCells(algo);
+        }
+    }
+
     void renderCells(Algo algo)
     {
         switch(algo) {
@@ -645,6 +991,13 @@ private:
 
     Algo algo_to_use;
 
+    std::vector<std::shared_ptr<HypothesisBase>> portfolio_;
+    bool portfolio_first_;
+
+    boost::shared_mutex generic_options_mutex_;
+    path_msgs::PlannerOptions generic_options_;
+    bool has_generic_options_;
+
     bool render_open_cells_;
     nav_msgs::GridCells cells;
     ros::Publisher cell_publisher_;
@@ -0,0 +1,56 @@
+#ifndef MAP_CONVERSION_H
+#define MAP_CONVERSION_H
+
+/// SYSTEM
+#include <stdint.h>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+namespace Utils_MapConversion
+{
+
+/**
+ * @brief Copy cost map values into the planner grid (no conversion necessary)
+ */
+inline void costToGrid(const int8_t* src, uint8_t* dst, std::size_t n)
+{
+    std::memcpy(dst, src, n);
+}
+
+/**
+ * @brief Reference implementation of occupancyToGrid, used for the remaining cells of the SIMD versions
+ */
+inline void occupancyToGridScalar(const int8_t* src, uint8_t* dst, std::size_t n)
+{
+    for(std::size_t i = 0; i < n; ++i) {
+        dst[i] = std::min(100, src[i] + 1);
+    }
+}
+
+/**
+ * @brief Reference implementation of gridToVisualization, used for the remaining cells of the SIMD versions
+ */
+inline void gridToVisualizationScalar(const uint8_t* src, int8_t* dst, std::size_t n, uint8_t free_threshold)
+{
+    for(std::size_t i = 0; i < n; ++i) {
+        dst[i] = src[i] <= free_threshold ? 255 : 0;
+    }
+}
+
+}
+
+/**
+ * @brief Include SIMD functions depending on requested CPU architecture
+ */
+
+
+#if defined(USE_AVX2) && defined(__AVX2__)
+#include "map_conversion_avx.h"
+#elif __SSE4_2__
+#include "map_conversion_sse.h"
+#else
+#include "map_conversion_nosimd.h"
+#endif
+
+#endif // MAP_CONVERSION_H
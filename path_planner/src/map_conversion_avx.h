@@ -0,0 +1,54 @@
+#ifndef MAP_CONVERSION_AVX
+#define MAP_CONVERSION_AVX
+
+
+#include <immintrin.h>
+
+
+/**
+ * @brief AVX2 implementation of the map conversion kernels
+ */
+namespace Utils_MapConversion
+{
+
+/**
+ * @brief Convert occupancy values (-1: unknown, 0-100: probability) to planner grid values (0: unknown, 1-100)
+ */
+inline void occupancyToGrid(const int8_t* src, uint8_t* dst, std::size_t n)
+{
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i max = _mm256_set1_epi8(100);
+
+    std::size_t i = 0;
+    for(; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(src + i));
+        // saturating add keeps 127 from wrapping before the minimum is taken
+        const __m256i res = _mm256_min_epi8(_mm256_adds_epi8(v, one), max);
+        _mm256_storeu_si256((__m256i*)(dst + i), res);
+    }
+
+    occupancyToGridScalar(src + i, dst + i, n - i);
+}
+
+/**
+ * @brief Convert planner grid values to a visualization grid (255: free, 0: not free)
+ * @note A cell counts as free, iff its value is not above free_threshold (cf. SimpleGridMap2d::isFree)
+ */
+inline void gridToVisualization(const uint8_t* src, int8_t* dst, std::size_t n, uint8_t free_threshold)
+{
+    const __m256i thres = _mm256_set1_epi8(free_threshold);
+
+    std::size_t i = 0;
+    for(; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(src + i));
+        // unsigned v <= thres  <=>  min(v, thres) == v
+        const __m256i res = _mm256_cmpeq_epi8(_mm256_min_epu8(v, thres), v);
+        _mm256_storeu_si256((__m256i*)(dst + i), res);
+    }
+
+    gridToVisualizationScalar(src + i, dst + i, n - i, free_threshold);
+}
+
+}
+
+#endif // MAP_CONVERSION_AVX
@@ -0,0 +1,30 @@
+#ifndef MAP_CONVERSION_NO_SIMD
+#define MAP_CONVERSION_NO_SIMD
+
+
+/**
+ * @brief Implementation of the map conversion kernels without SIMD
+ */
+namespace Utils_MapConversion
+{
+
+/**
+ * @brief Convert occupancy values (-1: unknown, 0-100: probability) to planner grid values (0: unknown, 1-100)
+ */
+inline void occupancyToGrid(const int8_t* src, uint8_t* dst, std::size_t n)
+{
+    occupancyToGridScalar(src, dst, n);
+}
+
+/**
+ * @brief Convert planner grid values to a visualization grid (255: free, 0: not free)
+ * @note A cell counts as free, iff its value is not above free_threshold (cf. SimpleGridMap2d::isFree)
+ */
+inline void gridToVisualization(const uint8_t* src, int8_t* dst, std::size_t n, uint8_t free_threshold)
+{
+    gridToVisualizationScalar(src, dst, n, free_threshold);
+}
+
+}
+
+#endif // MAP_CONVERSION_NO_SIMD
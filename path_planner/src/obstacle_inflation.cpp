@@ -0,0 +1,123 @@
+/// HEADER
+#include "obstacle_inflation.h"
+
+/// SYSTEM
+#include <opencv2/imgproc/imgproc.hpp>
+#include <algorithm>
+#include <cstring>
+
+ObstacleInflation::ObstacleInflation()
+    : radius_(-1), cells_updated_(0)
+{
+
+}
+
+std::size_t ObstacleInflation::cellsUpdated() const
+{
+    return cells_updated_;
+}
+
+const cv::Mat& ObstacleInflation::update(const cv::Mat &input, int radius)
+{
+    CV_Assert(input.type() == CV_8UC1);
+
+    const int w = input.cols;
+    const int h = input.rows;
+
+    cells_updated_ = 0;
+
+    if(radius != radius_ || input.size() != input_.size()) {
+        radius_ = radius;
+        element_ = cv::getStructuringElement(cv::MORPH_ELLIPSE,
+                                             cv::Size(2 * radius + 1, 2 * radius + 1),
+                                             cv::Point(radius, radius));
+
+        input.copyTo(input_);
+        cv::dilate(input_, inflated_, element_);
+        cells_updated_ = w * h;
+        return inflated_;
+    }
+
+    const int tiles_x = (w + TILE_SIZE - 1) / TILE_SIZE;
+    const int tiles_y = (h + TILE_SIZE - 1) / TILE_SIZE;
+
+    /// find the tiles that contain changed cells
+    std::vector<char> changed(tiles_x * tiles_y, 0);
+    bool any_change = false;
+    for(int y = 0; y < h; ++y) {
+        const uchar* row = input.ptr<uchar>(y);
+        uchar* last_row = input_.ptr<uchar>(y);
+        if(std::memcmp(row, last_row, w) == 0) {
+            continue;
+        }
+
+        char* changed_row = &changed[(y / TILE_SIZE) * tiles_x];
+        for(int tx = 0; tx < tiles_x; ++tx) {
+            int x0 = tx * TILE_SIZE;
+            int n = std::min(TILE_SIZE, w - x0);
+            if(std::memcmp(row + x0, last_row + x0, n) != 0) {
+                changed_row[tx] = 1;
+                any_change = true;
+            }
+        }
+        std::memcpy(last_row, row, w);
+    }
+
+    if(!any_change) {
+        return inflated_;
+    }
+
+    /// a change affects the output within the kernel radius -> grow the changed tiles
+    const int reach = (radius_ + TILE_SIZE - 1) / TILE_SIZE;
+    dirty_.assign(tiles_x * tiles_y, 0);
+    for(int ty = 0; ty < tiles_y; ++ty) {
+        for(int tx = 0; tx < tiles_x; ++tx) {
+            if(!changed[ty * tiles_x + tx]) {
+                continue;
+            }
+            for(int dy = std::max(0, ty - reach), ey = std::min(tiles_y - 1, ty + reach); dy <= ey; ++dy) {
+                for(int dx = std::max(0, tx - reach), ex = std::min(tiles_x - 1, tx + reach); dx <= ex; ++dx) {
+                    dirty_[dy * tiles_x + dx] = 1;
+                }
+            }
+        }
+    }
+
+    /// dilate runs of dirty tiles in each tile row
+    for(int ty = 0; ty < tiles_y; ++ty) {
+        int tx = 0;
+        while(tx < tiles_x) {
+            if(!dirty_[ty * tiles_x + tx]) {
+                ++tx;
+                continue;
+            }
+            int start = tx;
+            while(tx < tiles_x && dirty_[ty * tiles_x + tx]) {
+                ++tx;
+            }
+
+            int x0 = start * TILE_SIZE;
+            int y0 = ty * TILE_SIZE;
+            dilate(cv::Rect(x0, y0, std::min(tx * TILE_SIZE, w) - x0, std::min(y0 + TILE_SIZE, h) - y0));
+        }
+    }
+
+    return inflated_;
+}
+
+void ObstacleInflation::dilate(const cv::Rect &region)
+{
+    // the input is needed up to the kernel radius around the region
+    cv::Rect bounds(0, 0, input_.cols, input_.rows);
+    cv::Rect source(region.x - radius_, region.y - radius_, region.width + 2 * radius_, region.height + 2 * radius_);
+    source &= bounds;
+
+    // isolated, so the dilation only sees the source region like a full dilation sees the image
+    cv::Mat result;
+    cv::dilate(input_(source), result, element_, cv::Point(-1, -1), 1, cv::BORDER_CONSTANT | cv::BORDER_ISOLATED);
+
+    cv::Rect local(region.x - source.x, region.y - source.y, region.width, region.height);
+    result(local).copyTo(inflated_(region));
+
+    cells_updated_ += region.area();
+}
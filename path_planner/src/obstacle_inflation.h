@@ -0,0 +1,50 @@
+#ifndef OBSTACLE_INFLATION_H
+#define OBSTACLE_INFLATION_H
+
+/// SYSTEM
+#include <opencv2/core/core.hpp>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief The ObstacleInflation class dilates a grid with an elliptical kernel and keeps the result
+ *        between calls. Only tiles within the kernel radius of changed cells are dilated again.
+ *
+ * The inflated grid is identical to a full cv::dilate of the input.
+ */
+class ObstacleInflation
+{
+public:
+    enum { TILE_SIZE = 32 };
+
+public:
+    ObstacleInflation();
+
+    /**
+     * @brief update brings the inflated grid up to date with the given input grid
+     * @param input CV_8UC1 grid to inflate
+     * @param radius kernel radius in cells, changing the radius recomputes the whole grid
+     * @return the inflated grid, valid until the next call
+     */
+    const cv::Mat& update(const cv::Mat& input, int radius);
+
+    /**
+     * @brief cellsUpdated returns the number of cells dilated by the last update
+     */
+    std::size_t cellsUpdated() const;
+
+private:
+    void dilate(const cv::Rect& region);
+
+private:
+    int radius_;
+    cv::Mat element_;
+
+    cv::Mat input_;
+    cv::Mat inflated_;
+
+    std::vector<char> dirty_;
+    std::size_t cells_updated_;
+};
+
+#endif // OBSTACLE_INFLATION_H
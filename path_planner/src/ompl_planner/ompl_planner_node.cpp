@@ -104,7 +104,9 @@ private:
         setup.getPlanner()->clear();
         setup.getStateSpace()->getDefaultProjection()->setCellSizes(cs);
 
-        setup.solve(5);
+        // stop after 5s or as soon as the request is preempted
+        ob::PlannerTerminationCondition cancelled([this]() { return isCancelled(); });
+        setup.solve(ob::plannerOrTerminationCondition(ob::timedPlannerTerminationCondition(5), cancelled));
 
         // publish solution
         path_msgs::PathSequence path_sequence;
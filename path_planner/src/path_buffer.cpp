@@ -0,0 +1,95 @@
+/// HEADER
+#include "path_buffer.h"
+
+/// SYSTEM
+#include <tf/tf.h>
+
+PathBuffer::Segment::Segment()
+    : forward(true)
+{
+
+}
+
+std::size_t PathBuffer::Segment::size() const
+{
+    return x.size();
+}
+
+void PathBuffer::Segment::clear()
+{
+    x.clear();
+    y.clear();
+    theta.clear();
+}
+
+void PathBuffer::Segment::reserve(std::size_t n)
+{
+    x.reserve(n);
+    y.reserve(n);
+    theta.reserve(n);
+}
+
+void PathBuffer::Segment::push_back(double px, double py, double ptheta)
+{
+    x.push_back(px);
+    y.push_back(py);
+    theta.push_back(ptheta);
+}
+
+PathBuffer::PathBuffer()
+{
+
+}
+
+PathBuffer::PathBuffer(const path_msgs::PathSequence &path)
+{
+    assign(path);
+}
+
+void PathBuffer::assign(const path_msgs::PathSequence &path)
+{
+    header = path.header;
+    segments.resize(path.paths.size());
+
+    for(std::size_t s = 0; s < path.paths.size(); ++s) {
+        const path_msgs::DirectionalPath& dpath = path.paths[s];
+        Segment& segment = segments[s];
+
+        segment.header = dpath.header;
+        segment.forward = dpath.forward;
+        segment.pose_header = dpath.poses.empty() ? std_msgs::Header() : dpath.poses.front().header;
+
+        segment.clear();
+        segment.reserve(dpath.poses.size());
+        for(const geometry_msgs::PoseStamped& pose : dpath.poses) {
+            segment.push_back(pose.pose.position.x, pose.pose.position.y, tf::getYaw(pose.pose.orientation));
+        }
+    }
+}
+
+path_msgs::PathSequence PathBuffer::toMsg() const
+{
+    path_msgs::PathSequence path;
+    path.header = header;
+    path.paths.resize(segments.size());
+
+    for(std::size_t s = 0; s < segments.size(); ++s) {
+        const Segment& segment = segments[s];
+        path_msgs::DirectionalPath& dpath = path.paths[s];
+
+        dpath.header = segment.header;
+        dpath.forward = segment.forward;
+
+        std::size_t n = segment.size();
+        dpath.poses.resize(n);
+        for(std::size_t i = 0; i < n; ++i) {
+            geometry_msgs::PoseStamped& pose = dpath.poses[i];
+            pose.header = segment.pose_header;
+            pose.pose.position.x = segment.x[i];
+            pose.pose.position.y = segment.y[i];
+            pose.pose.orientation = tf::createQuaternionMsgFromYaw(segment.theta[i]);
+        }
+    }
+
+    return path;
+}
@@ -0,0 +1,54 @@
+#ifndef PATH_BUFFER_H
+#define PATH_BUFFER_H
+
+/// PROJECT
+#include <path_msgs/PathSequence.h>
+
+/// SYSTEM
+#include <vector>
+
+/**
+ * @brief The PathBuffer class is a structure-of-arrays representation of a PathSequence.
+ *        Post processing operates on it in place and only converts back to a message at the end.
+ */
+class PathBuffer
+{
+public:
+    struct Segment
+    {
+        Segment();
+
+        std::size_t size() const;
+        void clear();
+        void reserve(std::size_t n);
+        void push_back(double x, double y, double theta);
+
+        std_msgs::Header header;
+        std_msgs::Header pose_header;
+        bool forward;
+
+        std::vector<double> x;
+        std::vector<double> y;
+        std::vector<double> theta;
+    };
+
+public:
+    PathBuffer();
+    explicit PathBuffer(const path_msgs::PathSequence& path);
+
+    /**
+     * @brief assign replaces the content with the given path, reusing the allocated memory
+     */
+    void assign(const path_msgs::PathSequence& path);
+
+    /**
+     * @brief toMsg converts the buffer back to a message
+     */
+    path_msgs::PathSequence toMsg() const;
+
+public:
+    std_msgs::Header header;
+    std::vector<Segment> segments;
+};
+
+#endif // PATH_BUFFER_H
@@ -0,0 +1,155 @@
+/// HEADER
+#include "planner_diagnostics.h"
+
+/// COMPONENT
+#include "map_conversion.h"
+
+/// SYSTEM
+#include <opencv2/opencv.hpp>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+int64_t nowNs()
+{
+    return ros::WallTime::now().toNSec();
+}
+}
+
+PlannerDiagnostics::PlannerDiagnostics()
+    : enabled_(false), min_period_ns_(0), dropped_(0), shutdown_(false)
+{
+    for(std::atomic<int64_t>& last : last_push_ns_) {
+        last = 0;
+    }
+}
+
+PlannerDiagnostics::~PlannerDiagnostics()
+{
+    {
+        boost::lock_guard<boost::mutex> lock(wakeup_mutex_);
+        shutdown_ = true;
+    }
+    wakeup_.notify_all();
+    if(worker_.joinable()) {
+        worker_.join();
+    }
+
+    Item* item;
+    while(queue_.pop(item)) {
+        delete item;
+    }
+}
+
+void PlannerDiagnostics::start(const ros::Publisher &map_pub, const ros::Publisher &cost_pub,
+                               double rate, const std::string &costmap_file)
+{
+    map_pub_ = map_pub;
+    cost_pub_ = cost_pub;
+    costmap_file_ = costmap_file;
+    min_period_ns_ = rate > 0.0 ? static_cast<int64_t>(1e9 / rate) : 0;
+    enabled_ = true;
+
+    worker_ = boost::thread(boost::bind(&PlannerDiagnostics::run, this));
+}
+
+bool PlannerDiagnostics::enabled() const
+{
+    return enabled_;
+}
+
+bool PlannerDiagnostics::accepts(Channel channel) const
+{
+    if(!enabled_) {
+        return false;
+    }
+    return nowNs() - last_push_ns_[static_cast<int>(channel)] >= min_period_ns_;
+}
+
+void PlannerDiagnostics::pushMap(const nav_msgs::OccupancyGridPtr &map, bool convert, uint8_t free_threshold)
+{
+    Item* item = new Item;
+    item->channel = Channel::MAP;
+    item->grid = map;
+    item->convert = convert;
+    item->free_threshold = free_threshold;
+    push(item);
+}
+
+void PlannerDiagnostics::pushCostMap(const nav_msgs::OccupancyGridPtr &cost_map)
+{
+    Item* item = new Item;
+    item->channel = Channel::COST_MAP;
+    item->grid = cost_map;
+    item->convert = false;
+    item->free_threshold = 0;
+    push(item);
+}
+
+void PlannerDiagnostics::push(Item *item)
+{
+    last_push_ns_[static_cast<int>(item->channel)] = nowNs();
+
+    if(!queue_.push(item)) {
+        delete item;
+        ++dropped_;
+        ROS_DEBUG_STREAM_THROTTLE(5, "diagnostics queue is full, dropped " << dropped_ << " items so far");
+        return;
+    }
+
+    // the worker checks the queue while holding the mutex, so the notification cannot get lost
+    {
+        boost::lock_guard<boost::mutex> lock(wakeup_mutex_);
+    }
+    wakeup_.notify_one();
+}
+
+void PlannerDiagnostics::run()
+{
+    // diagnostics must not compete with planning
+    setpriority(PRIO_PROCESS, syscall(SYS_gettid), 19);
+
+    while(true) {
+        Item* item = nullptr;
+        {
+            boost::unique_lock<boost::mutex> lock(wakeup_mutex_);
+            while(!shutdown_ && !queue_.pop(item)) {
+                wakeup_.wait(lock);
+            }
+            if(shutdown_) {
+                return;
+            }
+        }
+
+        try {
+            process(*item);
+        } catch(const std::exception& e) {
+            ROS_WARN_STREAM("diagnostics failed: " << e.what());
+        }
+        delete item;
+    }
+}
+
+void PlannerDiagnostics::process(Item &item)
+{
+    nav_msgs::OccupancyGrid& grid = *item.grid;
+
+    switch(item.channel) {
+    case Channel::MAP:
+        if(item.convert) {
+            Utils_MapConversion::gridToVisualization(reinterpret_cast<const uint8_t*>(grid.data.data()),
+                                                     grid.data.data(), grid.data.size(), item.free_threshold);
+        }
+        map_pub_.publish(item.grid);
+        break;
+
+    case Channel::COST_MAP:
+        cost_pub_.publish(item.grid);
+        if(!costmap_file_.empty()) {
+            cv::Mat costmap(grid.info.height, grid.info.width, CV_8UC1, grid.data.data());
+            cv::imwrite(costmap_file_, costmap);
+        }
+        break;
+    }
+}
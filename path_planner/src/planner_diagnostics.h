@@ -0,0 +1,91 @@
+#ifndef PLANNER_DIAGNOSTICS_H
+#define PLANNER_DIAGNOSTICS_H
+
+/// SYSTEM
+#include <ros/ros.h>
+#include <nav_msgs/OccupancyGrid.h>
+#include <boost/lockfree/queue.hpp>
+#include <boost/thread.hpp>
+#include <atomic>
+
+/**
+ * @brief The PlannerDiagnostics class publishes and stores debug information on a background thread.
+ *        The planner only copies the data into a bounded lock-free queue, items are dropped when the queue is full.
+ */
+class PlannerDiagnostics
+{
+public:
+    enum class Channel {
+        MAP = 0, COST_MAP = 1
+    };
+
+public:
+    PlannerDiagnostics();
+    ~PlannerDiagnostics();
+
+    /**
+     * @brief start starts the diagnostics thread
+     * @param map_pub publisher for the final planning map
+     * @param cost_pub publisher for the cost map
+     * @param rate maximum number of items per second and channel
+     * @param costmap_file the cost map is written to this image file, if not empty
+     */
+    void start(const ros::Publisher& map_pub, const ros::Publisher& cost_pub,
+               double rate, const std::string& costmap_file);
+
+    /**
+     * @brief enabled is true after start has been called
+     */
+    bool enabled() const;
+
+    /**
+     * @brief accepts checks the rate limit of a channel, call this before copying data for an item
+     */
+    bool accepts(Channel channel) const;
+
+    /**
+     * @brief pushMap queues the planning map for publication
+     * @param map cell values, which are converted to free (255) / occupied (0) with the free_threshold,
+     *        or the final values, if convert is false
+     */
+    void pushMap(const nav_msgs::OccupancyGridPtr& map, bool convert, uint8_t free_threshold);
+
+    /**
+     * @brief pushCostMap queues the cost map for publication and for writing it to disk
+     */
+    void pushCostMap(const nav_msgs::OccupancyGridPtr& cost_map);
+
+private:
+    struct Item
+    {
+        Channel channel;
+        nav_msgs::OccupancyGridPtr grid;
+        bool convert;
+        uint8_t free_threshold;
+    };
+
+    void push(Item* item);
+    void run();
+    void process(Item& item);
+
+private:
+    static const std::size_t CAPACITY = 8;
+
+    bool enabled_;
+    ros::Publisher map_pub_;
+    ros::Publisher cost_pub_;
+    std::string costmap_file_;
+    int64_t min_period_ns_;
+
+    std::atomic<int64_t> last_push_ns_[2];
+    std::atomic<std::size_t> dropped_;
+
+    boost::lockfree::queue<Item*, boost::lockfree::capacity<CAPACITY>> queue_;
+
+    boost::thread worker_;
+    boost::mutex wakeup_mutex_;
+    boost::condition_variable wakeup_;
+    bool shutdown_;
+};
+
+#endif // PLANNER_DIAGNOSTICS_H
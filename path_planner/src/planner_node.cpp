@@ -1,6 +1,10 @@
 /// HEADER
 #include "planner_node.h"
 
+/// COMPONENT
+#include "map_conversion.h"
+#include "point_projection.h"
+
 /// PROJECT
 #include <cslibs_path_planning/common/CollisionGridMap2d.h>
 #include <cslibs_path_planning/common/RotatedGridMap2d.h>
@@ -14,6 +18,8 @@
 #include <opencv2/opencv.hpp>
 #include <pcl_ros/publisher.h>
 #include <string.h>
+#include <atomic>
+#include <limits>
 
 using namespace lib_path;
 
@@ -21,7 +27,10 @@ Planner::Planner()
     : nh_priv("~"),
       is_cost_map_(false),
       server_(nh, "plan_path", boost::bind(&Planner::execute, this, _1), false),
-      map_info(NULL), map_rotation_yaw_(0.0), thread_running(false)
+      map_info(NULL), map_rotation_yaw_(0.0),
+      modified_x0_(0), modified_y0_(0), modified_x1_(0), modified_y1_(0),
+      cost_map_revision_(0), published_cost_map_revision_(std::numeric_limits<std::size_t>::max()),
+      worker_shutdown_(false), worker_has_job_(false), worker_busy_(false), worker_preliminary_(false)
 {
     std::string target_topic = "/goal";
     nh_priv.param("target_topic", target_topic, target_topic);
@@ -100,6 +109,12 @@ Planner::Planner()
     cost_pub = nh_priv.advertise<nav_msgs::OccupancyGrid>("cost", 1, true);
     map_pub = nh_priv.advertise<nav_msgs::OccupancyGrid>("map", 1, true);
 
+    if(nh_priv.param("diagnostics/enabled", true)) {
+        double rate = nh_priv.param("diagnostics/rate", 1.0);
+        std::string costmap_file = nh_priv.param("diagnostics/costmap_file", std::string(""));
+        diagnostics_.start(map_pub, cost_pub, rate, costmap_file);
+    }
+
     std::string default_world_frame = nh.param("gerona/world_frame", std::string("map"));
     nh_priv.param("world_frame", world_frame_, default_world_frame);
 
@@ -107,6 +122,30 @@ Planner::Planner()
     nh_priv.param("robot_frame", robot_frame_, default_robot_frame);
 
 
+    int heuristic_cache_size;
+    nh_priv.param("heuristic_cache/size", heuristic_cache_size, 0);
+    if(heuristic_cache_size > 0) {
+        heuristic_cache_.reset(new HeuristicCache(heuristic_cache_size));
+
+        XmlRpc::XmlRpcValue goals;
+        if(nh_priv.getParam("heuristic_cache/goals", goals) && goals.getType() == XmlRpc::XmlRpcValue::TypeArray) {
+            for(int i = 0; i < goals.size(); ++i) {
+                XmlRpc::XmlRpcValue& goal = goals[i];
+                if(goal.getType() != XmlRpc::XmlRpcValue::TypeArray || goal.size() != 2) {
+                    ROS_WARN_STREAM("ignoring heuristic cache goal " << i << ", expected [x, y]");
+                    continue;
+                }
+                heuristic_cache_goals_.emplace_back(static_cast<double>(goal[0]), static_cast<double>(goal[1]));
+            }
+        }
+    }
+
+
+    int batch_threads;
+    nh_priv.param("batch/threads", batch_threads, 0);
+    batch_threads_ = batch_threads > 0 ? batch_threads : std::max(1u, boost::thread::hardware_concurrency());
+
+
     nh_priv.param("size/forward", size_forward, 0.4);
     nh_priv.param("size/backward", size_backward, -0.6);
     nh_priv.param("size/width", size_width, 0.5);
@@ -114,56 +153,272 @@ Planner::Planner()
     path_publisher_ = nh.advertise<path_msgs::PathSequence> ("path", 10);
     raw_path_publisher_ = nh.advertise<nav_msgs::Path> ("path_raw", 10);
 
+    worker_thread_ = boost::thread(boost::bind(&Planner::planningWorker, this));
+
     server_.registerPreemptCallback(boost::bind(&Planner::preempt, this));
     server_.start();
+
+    ros::AdvertiseServiceOptions batch_options = ros::AdvertiseServiceOptions::create<path_msgs::PlanPathBatch>(
+                "plan_path_batch", boost::bind(&Planner::planBatch, this, _1, _2), ros::VoidPtr(), &batch_queue_);
+    batch_server_ = nh.advertiseService(batch_options);
+    batch_spinner_.reset(new ros::AsyncSpinner(1, &batch_queue_));
+    batch_spinner_->start();
 }
 
 Planner::~Planner()
 {
+    batch_spinner_->stop();
+    batch_server_.shutdown();
 
+    {
+        boost::lock_guard<boost::mutex> lock(worker_mutex_);
+        worker_shutdown_ = true;
+        if(worker_token_) {
+            worker_token_->cancel();
+        }
+    }
+    worker_wakeup_.notify_all();
+    worker_thread_.join();
 }
 
 void Planner::preempt()
 {
     ROS_WARN("preempting!!");
 
-    thread_mutex.lock();
-    bool running = thread_running;
-    thread_mutex.unlock();
-    if(running) {
-        ROS_WARN_STREAM("preempting path planner");
-        thread_->interrupt();
-        thread_->join();
+    {
+        boost::lock_guard<boost::mutex> lock(worker_mutex_);
+        if(worker_busy_ && worker_token_) {
+            ROS_WARN_STREAM("preempting path planner");
+            worker_token_->cancel();
+        }
     }
+    worker_done_.notify_all();
 
     server_.setPreempted();
 
     ROS_WARN_STREAM("done preempting path planner");
 }
 
-void Planner::feedback(int status)
+void Planner::feedback(int status, const std::vector<path_msgs::ProcessingTime>& timings)
 {
     if(server_.isActive()) {
         path_msgs::PlanPathFeedback f;
         f.status = status;
+        f.timings = timings;
+        server_.publishFeedback(f);
+    }
+}
+
+void Planner::feedbackPreliminaryPath(const path_msgs::PathSequence& path)
+{
+    if(server_.isActive()) {
+        path_msgs::PlanPathFeedback f;
+        f.status = path_msgs::PlanPathFeedback::STATUS_PRELIMINARY_PATH;
+        f.path = path;
         server_.publishFeedback(f);
     }
 }
 
 void Planner::updateMapCallback (const nav_msgs::OccupancyGridConstPtr &map)
 {
-    pending_map = map;
+    // build the next map snapshot right away, running searches keep their own snapshot
+    updateMap(*map, false);
+}
+
+Planner::MapSnapshot::ConstPtr Planner::currentMapSnapshot()
+{
+    boost::lock_guard<boost::mutex> lock(snapshot_mutex_);
+    return map_snapshot_;
 }
 
 void Planner::updateMap (const nav_msgs::OccupancyGrid &map, bool is_cost_map)
 {
-    boost::lock_guard<boost::mutex> lock(map_mutex);
+    // only serializes map ingest, planning works on its own snapshot
+    boost::lock_guard<boost::mutex> lock(map_ingest_mutex_);
 
-    is_cost_map_ = is_cost_map;
+    MapSnapshot::ConstPtr current = currentMapSnapshot();
 
     unsigned w = map.info.width;
     unsigned h = map.info.height;
 
+    MapConversion conversion;
+    if(is_cost_map) {
+        conversion = MapConversion::COST;
+
+    } else {
+        bool use_unknown;
+        nh_priv.param("use_unknown_cells", use_unknown, true);
+
+        conversion = use_unknown ? MapConversion::OCCUPANCY_UNKNOWN : MapConversion::OCCUPANCY_RAW;
+    }
+
+    std::shared_ptr<MapSnapshot> next(new MapSnapshot);
+    next->header = map.header;
+    next->info = map.info;
+    next->is_cost_map = is_cost_map;
+    next->conversion = conversion;
+    next->created = ros::WallTime::now();
+
+    std::size_t n = w * h;
+    bool full_update = !current ||
+            current->info.width != w ||
+            current->info.height != h ||
+            current->conversion != conversion;
+
+    auto copyRow = [&map, w](unsigned x, unsigned y, unsigned len, int8_t* cells) {
+        std::memcpy(cells, &map.data[y * w + x], len);
+    };
+    auto convertRow = [&map, w, conversion](unsigned x, unsigned y, unsigned len, uint8_t* cells) {
+        convertMapRow(&map.data[y * w + x], conversion, cells, len);
+    };
+
+    if(full_update) {
+        std::shared_ptr<TiledGrid<int8_t>> raw(new TiledGrid<int8_t>(w, h));
+        std::shared_ptr<TiledGrid<uint8_t>> data(new TiledGrid<uint8_t>(w, h));
+        for(unsigned ty = 0; ty < raw->tilesY(); ++ty) {
+            for(unsigned tx = 0; tx < raw->tilesX(); ++tx) {
+                raw->writeTile(tx, ty, copyRow);
+                data->writeTile(tx, ty, convertRow);
+            }
+        }
+
+        next->raw = raw;
+        next->data = data;
+        next->revision = current ? current->revision + 1 : 0;
+        next->cells_updated = n;
+        next->changed_x0 = 0;
+        next->changed_y0 = 0;
+        next->changed_x1 = w;
+        next->changed_y1 = h;
+
+    } else {
+        const TiledGrid<int8_t>& last_raw = *current->raw;
+
+        // copy on write, the current snapshot may still be in use by a search
+        std::shared_ptr<TiledGrid<int8_t>> raw(new TiledGrid<int8_t>(last_raw));
+        std::shared_ptr<TiledGrid<uint8_t>> data(new TiledGrid<uint8_t>(*current->data));
+
+        /// find the tiles and the bounding box of all cells that changed since the last map,
+        /// only the changed tiles are cloned
+        unsigned x0 = w, x1 = 0;
+        unsigned y0 = h, y1 = 0;
+        std::size_t cells_updated = 0;
+        for(unsigned ty = 0; ty < last_raw.tilesY(); ++ty) {
+            for(unsigned tx = 0; tx < last_raw.tilesX(); ++tx) {
+                bool changed = false;
+                last_raw.readTile(tx, ty, [&](unsigned x, unsigned y, unsigned len, const int8_t* last_row) {
+                    const int8_t* row = &map.data[y * w + x];
+                    if(std::memcmp(row, last_row, len) == 0) {
+                        return;
+                    }
+
+                    unsigned first = 0;
+                    while(row[first] == last_row[first]) {
+                        ++first;
+                    }
+                    unsigned last = len - 1;
+                    while(row[last] == last_row[last]) {
+                        --last;
+                    }
+
+                    x0 = std::min(x0, x + first);
+                    x1 = std::max(x1, x + last + 1);
+                    y0 = std::min(y0, y);
+                    y1 = std::max(y1, y + 1);
+                    changed = true;
+                });
+
+                if(changed) {
+                    raw->writeTile(tx, ty, copyRow);
+                    data->writeTile(tx, ty, [&](unsigned x, unsigned y, unsigned len, uint8_t* cells) {
+                        convertRow(x, y, len, cells);
+                        cells_updated += len;
+                    });
+                }
+            }
+        }
+
+        if(x0 < x1) {
+            next->raw = raw;
+            next->data = data;
+            next->revision = current->revision + 1;
+            next->cells_updated = cells_updated;
+            next->changed_x0 = x0;
+            next->changed_y0 = y0;
+            next->changed_x1 = x1;
+            next->changed_y1 = y1;
+
+        } else {
+            // unchanged cells, the buffers can be shared
+            next->raw = current->raw;
+            next->data = current->data;
+            next->revision = current->revision;
+            next->cells_updated = 0;
+            next->changed_x0 = next->changed_x1 = 0;
+            next->changed_y0 = next->changed_y1 = 0;
+        }
+    }
+
+    ROS_DEBUG_STREAM("map update touched " << next->cells_updated << " of " << n << " cells");
+
+    {
+        boost::lock_guard<boost::mutex> snapshot_lock(snapshot_mutex_);
+        map_snapshot_ = next;
+    }
+
+    if(heuristic_cache_ && (!current || next->revision != current->revision)) {
+        updateHeuristicCache(*next);
+    }
+}
+
+void Planner::updateHeuristicCache(const MapSnapshot &snapshot)
+{
+    HeuristicCache::Grid grid;
+    grid.data = snapshot.data;
+    grid.width = snapshot.info.width;
+    grid.height = snapshot.info.height;
+    grid.revision = snapshot.revision;
+    grid.changed_x0 = snapshot.changed_x0;
+    grid.changed_y0 = snapshot.changed_y0;
+    grid.changed_x1 = snapshot.changed_x1;
+    grid.changed_y1 = snapshot.changed_y1;
+
+    // only cells that are certainly occupied block, so the cost-to-go never overestimates
+    grid.obstacle_threshold = snapshot.conversion == MapConversion::COST ? 254 : occThreshold_;
+
+    heuristic_cache_->setGrid(grid);
+
+    const nav_msgs::MapMetaData& info = snapshot.info;
+    double yaw = tf::getYaw(info.origin.orientation);
+    double c = std::cos(-yaw);
+    double s = std::sin(-yaw);
+    for(const std::pair<double, double>& goal : heuristic_cache_goals_) {
+        double dx = goal.first - info.origin.position.x;
+        double dy = goal.second - info.origin.position.y;
+        int x = std::floor((c * dx - s * dy) / info.resolution);
+        int y = std::floor((s * dx + c * dy) / info.resolution);
+        heuristic_cache_->prefetch(x, y);
+    }
+}
+
+HeuristicCache::Field::ConstPtr Planner::holonomicHeuristic(const lib_path::Pose2d &goal_map)
+{
+    if(!heuristic_cache_ || !active_snapshot_) {
+        return nullptr;
+    }
+    // only a field of the snapshot that is planned on matches map_info, the cache may already have a newer map
+    return heuristic_cache_->get((int) goal_map.x, (int) goal_map.y, active_snapshot_->revision);
+}
+
+void Planner::activateMapSnapshot(const MapSnapshot::ConstPtr &snapshot)
+{
+    const nav_msgs::MapMetaData& info = snapshot->info;
+
+    unsigned w = info.width;
+    unsigned h = info.height;
+
+    is_cost_map_ = snapshot->is_cost_map;
+
     bool replace = map_info == NULL ||
             map_info->getWidth() != w ||
             map_info->getHeight() != h;
@@ -175,64 +430,99 @@ void Planner::updateMap (const nav_msgs::OccupancyGrid &map, bool is_cost_map)
 
 
         if(use_collision_gridmap_) {
-            map_info = new lib_path::CollisionGridMap2d(map.info.width, map.info.height, tf::getYaw(map.info.origin.orientation), map.info.resolution, size_forward, size_backward, size_width);
+            map_info = new lib_path::CollisionGridMap2d(info.width, info.height, tf::getYaw(info.origin.orientation), info.resolution, size_forward, size_backward, size_width);
         } else {
             tf::Quaternion orientation;
-            tf::quaternionMsgToTF(map.info.origin.orientation, orientation);
+            tf::quaternionMsgToTF(info.origin.orientation, orientation);
             if(orientation != tf::Quaternion(0., 0., 0., 1.0)) {
                 map_rotation_yaw_ = tf::getYaw(orientation);
-                map_info = new lib_path::RotatedGridMap2d(map.info.width, map.info.height, map_rotation_yaw_, map.info.resolution);
+                map_info = new lib_path::RotatedGridMap2d(info.width, info.height, map_rotation_yaw_, info.resolution);
             } else {
-                map_info = new lib_path::SimpleGridMap2d(map.info.width, map.info.height, map.info.resolution);
+                map_info = new lib_path::SimpleGridMap2d(info.width, info.height, info.resolution);
             }
         }
     }
 
-    std::vector<uint8_t> data(w*h);
-    int i = 0;
-
-    if(is_cost_map) {
+    if(is_cost_map_) {
         map_info->setLowerThreshold(253);
         map_info->setUpperThreshold(254);
         map_info->setNoInformationValue(255);
 
-        for(std::vector<int8_t>::const_iterator it = map.data.begin(); it != map.data.end(); ++it) {
-            uint8_t val = *it;
-            data[i++] = val;
-        }
-
-
     } else {
-        bool use_unknown;
-        nh_priv.param("use_unknown_cells", use_unknown, true);
+        map_info->setLowerThreshold(freeThreshold_);
+        map_info->setUpperThreshold(occThreshold_);
+        map_info->setNoInformationValue(-1);
+    }
 
-        if(use_unknown) {
-            /// Map data
-            /// -1: unknown -> 0
-            /// 0:100 probabilities -> 1 - 100
-            for(std::vector<int8_t>::const_iterator it = map.data.begin(); it != map.data.end(); ++it) {
-                data[i++] = std::min(100, *it + 1);
-            }
+    const TiledGrid<uint8_t>& data = *snapshot->data;
+    uint8_t* grid = map_info->getData();
 
-        } else {
-            /// Map data
-            /// -1: unknown -> -1
-            /// 0:100 probabilities -> 0 - 100
-            for(std::vector<int8_t>::const_iterator it = map.data.begin(); it != map.data.end(); ++it) {
-                data[i++] = *it;
+    if(replace || !active_snapshot_ || active_snapshot_->data->width() != w || active_snapshot_->data->height() != h) {
+        data.copyTo(grid, 0, 0, w, h);
+
+    } else {
+        /// restore the cells that sensor data and obstacle growing have written into the grid
+        data.copyTo(grid, modified_x0_, modified_y0_, modified_x1_, modified_y1_);
+
+        /// and the tiles that changed since the active snapshot, which can be several revisions old
+        if(snapshot->data != active_snapshot_->data) {
+            const TiledGrid<uint8_t>& active = *active_snapshot_->data;
+            const unsigned tile = TiledGrid<uint8_t>::TILE_SIZE;
+            for(unsigned ty = 0; ty < data.tilesY(); ++ty) {
+                for(unsigned tx = 0; tx < data.tilesX(); ++tx) {
+                    if(!data.sharesTile(active, tx, ty)) {
+                        data.copyTo(grid, tx * tile, ty * tile, (tx + 1) * tile, (ty + 1) * tile);
+                    }
+                }
             }
         }
+    }
+    modified_x0_ = modified_y0_ = modified_x1_ = modified_y1_ = 0;
 
-        map_info->setLowerThreshold(freeThreshold_);
-        map_info->setUpperThreshold(occThreshold_);
-        map_info->setNoInformationValue(-1);
+    map_info->setOrigin(Point2d(info.origin.position.x, info.origin.position.y));
+
+    cost_map.header = snapshot->header;
+    cost_map.info = info;
+
+    active_snapshot_ = snapshot;
+}
+
+void Planner::markModified(int x0, int y0, int x1, int y1)
+{
+    if(x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    if(modified_x0_ >= modified_x1_ || modified_y0_ >= modified_y1_) {
+        modified_x0_ = x0;
+        modified_y0_ = y0;
+        modified_x1_ = x1;
+        modified_y1_ = y1;
+        return;
     }
+    modified_x0_ = std::min(modified_x0_, x0);
+    modified_y0_ = std::min(modified_y0_, y0);
+    modified_x1_ = std::max(modified_x1_, x1);
+    modified_y1_ = std::max(modified_y1_, y1);
+}
 
-    map_info->set(data, w, h);
-    map_info->setOrigin(Point2d(map.info.origin.position.x, map.info.origin.position.y));
+void Planner::convertMapRow(const int8_t* src, MapConversion conversion, uint8_t* dst, int len)
+{
+    switch(conversion) {
+    case MapConversion::OCCUPANCY_UNKNOWN:
+        /// Map data
+        /// -1: unknown -> 0
+        /// 0:100 probabilities -> 1 - 100
+        Utils_MapConversion::occupancyToGrid(src, dst, len);
+        break;
 
-    cost_map.header = map.header;
-    cost_map.info = map.info;
+    default:
+        /// Map data
+        /// -1: unknown -> -1
+        /// 0:100 probabilities -> 0 - 100
+        /// cost maps are copied as is
+        Utils_MapConversion::costToGrid(src, dst, len);
+        break;
+    }
 }
 
 void Planner::visualizeOutline(const geometry_msgs::Pose& at, int id, const std::string &frame)
@@ -413,10 +703,59 @@ void Planner::execute(const path_msgs::PlanPathGoalConstPtr &goal)
 }
 
 path_msgs::PathSequence Planner::findPath(const path_msgs::PlanPathGoal& request)
+{
+    boost::lock_guard<boost::mutex> request_lock(request_mutex_);
+
+    if(!prepareMap({ &request }, true)) {
+        return path_msgs::PathSequence();
+    }
+
+    Stopwatch sw;
+    sw.reset();
+    preprocess({ &request }, true);
+    ROS_DEBUG_STREAM("preprocessing took " << sw.msElapsed() << "ms");
+
+    // the preliminary and the final search share the token and the search time of the request,
+    // the deadline only stops searches that exceed their time limit
+    CancellationToken::Ptr token(new CancellationToken);
+    ros::Time now = ros::Time::now();
+    ros::Time search_deadline = now + ros::Duration(request.options.max_search_duration);
+    ros::Time deadline = now + ros::Duration(std::max(request.options.max_search_duration, 40.f));
+
+    if(request.options.anytime) {
+        sw.reset();
+        path_msgs::PathSequence preliminary = doPlan(request, token, search_deadline, deadline, true);
+        ROS_DEBUG_STREAM("preliminary planning took " << sw.msElapsed() << "ms");
+
+        if(!preliminary.paths.empty()) {
+            feedbackPreliminaryPath(preliminary);
+        }
+    }
+
+    sw.reset();
+    path_msgs::PathSequence path_raw = doPlan(request, token, search_deadline, deadline, false);
+    ROS_DEBUG_STREAM("planning took " << sw.msElapsed() << "ms");
+
+    path_msgs::PathSequence path;
+    if(post_process_ && !path_raw.paths.empty()) {
+        sw.reset();
+        path = postprocess(path_raw);
+        ROS_DEBUG_STREAM("postprocessing took " << sw.msElapsed() << "ms");
+    } else {
+        path = path_raw;
+    }
+
+    sw.reset();
+    publish(path, path_raw);
+    ROS_DEBUG_STREAM("publish took " << sw.msElapsed() << "ms");
+    return path;
+}
+
+bool Planner::prepareMap(const std::vector<const path_msgs::PlanPathGoal*>& requests, bool send_feedback)
 {
     Stopwatch sw;
-    if(use_map_topic_ && pending_map) {
-        updateMap(*pending_map, false);
+    if(use_map_topic_) {
+        // map messages are integrated by updateMapCallback
 
     } else if(use_cost_map_service_) {
         sw.reset();
@@ -426,6 +765,7 @@ path_msgs::PathSequence Planner::findPath(const path_msgs::PlanPathGoal& request
         }
         if(cost_map_service_client.call(map_service)) {
             cost_map = map_service.response.map;
+            ++cost_map_revision_;
             updateMap(map_service.response.map, true);
         } else {
             ROS_ERROR("call to costmap service failed");
@@ -439,7 +779,7 @@ path_msgs::PathSequence Planner::findPath(const path_msgs::PlanPathGoal& request
             updateMap(map_service.response.map, false);
         } else {
             ROS_ERROR("map service lookup failed");
-            return path_msgs::PathSequence();
+            return false;
         }
         ROS_INFO_STREAM("map service lookup took " << sw.msElapsed() << "ms");
 
@@ -449,139 +789,224 @@ path_msgs::PathSequence Planner::findPath(const path_msgs::PlanPathGoal& request
         empty_map.header.stamp = ros::Time::now();
         empty_map.info.resolution = 0.05;
 
-        double w = 0.0;
-        double h = 0.0;
+        // the map has to contain all start and goal poses plus a margin
+        double min_x = std::numeric_limits<double>::infinity();
+        double min_y = std::numeric_limits<double>::infinity();
+        double max_x = -std::numeric_limits<double>::infinity();
+        double max_y = -std::numeric_limits<double>::infinity();
+        auto include = [&](const geometry_msgs::Point& pt, double margin) {
+            min_x = std::min(min_x, pt.x - margin);
+            min_y = std::min(min_y, pt.y - margin);
+            max_x = std::max(max_x, pt.x + margin);
+            max_y = std::max(max_y, pt.y + margin);
+        };
+
+        for(const path_msgs::PlanPathGoal* request : requests) {
+            geometry_msgs::PoseStamped start = request->use_start ? request->start : lookupPose();
+
+            switch(request->goal.type) {
+            case path_msgs::Goal::GOAL_TYPE_POSE:
+                include(start.pose.position, 5.0);
+                include(request->goal.pose.pose.position, 5.0);
+                break;
 
-        geometry_msgs::PoseStamped start = request.use_start ? request.start : lookupPose();
+            case path_msgs::Goal::GOAL_TYPE_MAP:
+                include(start.pose.position, 40.0);
+                break;
 
-        switch(request.goal.type) {
-        case path_msgs::Goal::GOAL_TYPE_POSE: {
-            lib_path::Pose2d from_map;
-            from_map.x  = start.pose.position.x / empty_map.info.resolution;
-            from_map.y  = start.pose.position.y / empty_map.info.resolution;
-            from_map.theta  = tf::getYaw(start.pose.orientation);
+            default:
+                ROS_FATAL_STREAM("requested goal type " << request->goal.type << " is unknown.");
+                return false;
+            }
+        }
 
-            lib_path::Pose2d to_map;
-            to_map.x  = request.goal.pose.pose.position.x / empty_map.info.resolution;
-            to_map.y  = request.goal.pose.pose.position.y / empty_map.info.resolution;
-            to_map.theta  = tf::getYaw(request.goal.pose.pose.orientation);
+        empty_map.info.width = (max_x - min_x) / empty_map.info.resolution;
+        empty_map.info.height = (max_y - min_y) / empty_map.info.resolution;
+        empty_map.info.origin.position.x = min_x;
+        empty_map.info.origin.position.y = min_y;
+        empty_map.info.origin.orientation.w = 1.0;
+        empty_map.data.resize(empty_map.info.width * empty_map.info.height, 0);
 
-            int min_x = std::min(from_map.x, to_map.x);
-            int max_x = std::max(from_map.x, to_map.x);
+        ROS_DEBUG_STREAM("no map to use, generate empty map");
+        updateMap(empty_map, false);
+    }
 
-            int min_y = std::min(from_map.y, to_map.y);
-            int max_y = std::max(from_map.y, to_map.y);
+    MapSnapshot::ConstPtr snapshot = currentMapSnapshot();
+    if(!snapshot) {
+        ROS_ERROR("request for path planning, but no map there yet...");
+        return false;
+    }
 
-            int margin = 5.0 / empty_map.info.resolution;
+    double snapshot_age = (ros::WallTime::now() - snapshot->created).toSec() * 1e3;
+    ROS_DEBUG_STREAM("planning on map revision " << snapshot->revision << ", snapshot age is " << snapshot_age << "ms");
+    {
+        boost::lock_guard<boost::mutex> lock(map_mutex);
+        activateMapSnapshot(snapshot);
+    }
+    if(send_feedback) {
+        path_msgs::ProcessingTime age;
+        age.stage = "map snapshot age";
+        age.duration_ms = snapshot_age;
+        feedback(path_msgs::PlanPathFeedback::STATUS_PRE_PROCESSING, { age });
+    }
 
-            empty_map.info.width = max_x - min_x + 2 * margin;
-            empty_map.info.height = max_y - min_y + 2 * margin;
+    return true;
+}
 
-            w = empty_map.info.width * empty_map.info.resolution;
-            h = empty_map.info.height * empty_map.info.resolution;
+bool Planner::planBatch(path_msgs::PlanPathBatch::Request &req, path_msgs::PlanPathBatch::Response &res)
+{
+    std::size_t n = req.queries.size();
+    res.paths.resize(n);
+    res.search_ms.resize(n, 0.0);
+    res.postprocessing_ms.resize(n, 0.0);
 
-            empty_map.info.origin.position.x = (to_map.x + from_map.x) * empty_map.info.resolution / 2.0 - w/2.0;
-            empty_map.info.origin.position.y = (to_map.y + from_map.y) * empty_map.info.resolution / 2.0 - h/2.0;
-            break;
-        }
-        case path_msgs::Goal::GOAL_TYPE_MAP:
-            w = 80.0;
-            h = 80.0;
-            empty_map.info.width = w / empty_map.info.resolution;
-            empty_map.info.height = h / empty_map.info.resolution;
-            empty_map.info.origin.position.x = start.pose.position.x - w/2.0;
-            empty_map.info.origin.position.y = start.pose.position.y - h/2.0;
-
-            break;
-
-        default:
-            ROS_FATAL_STREAM("requested goal type " << request.goal.type << " is unknown.");
-            return empty();
-        }
+    if(n == 0) {
+        return true;
+    }
 
-        empty_map.info.origin.orientation.w = 1.0;
-        empty_map.data.resize(empty_map.info.width * empty_map.info.height, 0);
+    ROS_INFO_STREAM("planning a batch of " << n << " queries");
 
-        ROS_DEBUG_STREAM("no map to use, generate empty map");
-        updateMap(empty_map, false);
+    Stopwatch sw;
+    auto stage_done = [&](const std::string& stage) {
+        path_msgs::ProcessingTime t;
+        t.stage = stage;
+        t.duration_ms = sw.msElapsed();
+        res.timings.push_back(t);
+        ROS_DEBUG_STREAM("batch " << stage << " took " << t.duration_ms << "ms");
+        sw.restart();
+    };
+
+    double growth_radius = obstacleGrowthRadius(req.queries.front());
+    for(const path_msgs::PlanPathGoal& query : req.queries) {
+        if(!supportsGoalType(query.goal.type)) {
+            ROS_ERROR_STREAM("requested goal type " << query.goal.type << " is not supported.");
+            return false;
+        }
+        // obstacles are integrated once for the whole batch
+        if(obstacleGrowthRadius(query) != growth_radius) {
+            ROS_ERROR_STREAM("all queries of a batch have to use the same obstacle growth radius");
+            return false;
+        }
     }
 
-    if(map_info == NULL) {
-        ROS_ERROR("request for path planning, but no map there yet...");
-        return path_msgs::PathSequence();
+    std::vector<const path_msgs::PlanPathGoal*> requests;
+    for(const path_msgs::PlanPathGoal& query : req.queries) {
+        requests.push_back(&query);
     }
-    //    cv::Mat map_raw(map_info->getHeight(), map_info->getWidth(), CV_8UC1, map_info->getData());
-    //    cv::imshow("map_raw", map_raw);
-    //    cv::waitKey(100);
 
+    // the batch neither interleaves with an action request nor reports to it
+    boost::lock_guard<boost::mutex> request_lock(request_mutex_);
 
+    if(!prepareMap(requests, false)) {
+        return false;
+    }
+    stage_done("map preparation");
 
-    sw.reset();
-    preprocess(request);
-    ROS_DEBUG_STREAM("preprocessing took " << sw.msElapsed() << "ms");
+    preprocess(requests, false);
+    stage_done("preprocessing");
+
+    std::vector<path_msgs::PathSequence> paths_raw(n);
+    {
+        boost::lock_guard<boost::mutex> lock(map_mutex);
 
+        // the queries check the token of the batch, the worker sets its own before every search
+        CancellationToken::Ptr token(new CancellationToken);
+        planning_token_ = token;
+
+        std::atomic<std::size_t> next(0);
+        auto work = [&]() {
+            for(std::size_t i = next++; i < n; i = next++) {
+                Stopwatch query_sw;
+                try {
+                    paths_raw[i] = planQuery(req.queries[i]);
+                } catch(const std::exception& e) {
+                    ROS_ERROR_STREAM("batch query " << i << " failed: " << e.what());
+                }
+                res.search_ms[i] = query_sw.msElapsed();
+            }
+        };
 
-    sw.reset();
-    path_msgs::PathSequence path_raw = doPlan(request);
-    ROS_DEBUG_STREAM("planning took " << sw.msElapsed() << "ms");
+        boost::thread_group pool;
+        for(std::size_t t = 0, threads = std::min<std::size_t>(n, batch_threads_); t < threads; ++t) {
+            pool.create_thread(work);
+        }
+        pool.join_all();
+    }
+    stage_done("planning");
 
-    path_msgs::PathSequence path;
-    if(post_process_ && !path_raw.paths.empty()) {
-        sw.reset();
-        path = postprocess(path_raw);
-        ROS_DEBUG_STREAM("postprocessing took " << sw.msElapsed() << "ms");
-    } else {
-        path = path_raw;
+    for(std::size_t i = 0; i < n; ++i) {
+        if(post_process_ && !paths_raw[i].paths.empty()) {
+            Stopwatch query_sw;
+            res.paths[i] = postprocess(paths_raw[i], false);
+            res.postprocessing_ms[i] = query_sw.msElapsed();
+        } else {
+            res.paths[i] = paths_raw[i];
+        }
     }
+    stage_done("postprocessing");
 
-    sw.reset();
-    publish(path, path_raw);
-    ROS_DEBUG_STREAM("publish took " << sw.msElapsed() << "ms");
-    return path;
+    return true;
 }
 
-
-void Planner::preprocess(const path_msgs::PlanPathGoal& request)
+void Planner::preprocess(const std::vector<const path_msgs::PlanPathGoal*>& requests, bool send_feedback)
 {
     boost::lock_guard<boost::mutex> lock(map_mutex);
 
-    feedback(path_msgs::PlanPathFeedback::STATUS_PRE_PROCESSING);
+    if(send_feedback) {
+        feedback(path_msgs::PlanPathFeedback::STATUS_PRE_PROCESSING);
+    }
+
+    sensor_msgs::PointCloud2ConstPtr cloud;
+    sensor_msgs::LaserScanConstPtr front, back;
+    {
+        boost::lock_guard<boost::mutex> sensor_lock(sensor_mutex_);
+        cloud = cloud_;
+        front = scan_front;
+        back = scan_back;
+    }
 
-    if(use_cloud_ && !cloud_.data.empty()) {
-        integratePointCloud(cloud_);
+    if(use_cloud_ && cloud && !cloud->data.empty()) {
+        integratePointCloud(*cloud);
     }
-    if(use_scan_front_ && !scan_front.ranges.empty()) {
-        integrateLaserScan(scan_front);
+    if(use_scan_front_ && front && !front->ranges.empty()) {
+        integrateLaserScan(*front, scan_table_front_);
     }
-    if(use_scan_back_ && !scan_back.ranges.empty()) {
-        integrateLaserScan(scan_back);
+    if(use_scan_back_ && back && !back->ranges.empty()) {
+        integrateLaserScan(*back, scan_table_back_);
     }
 
     if(grow_obstacles_ != 0.0) {
-        growObstacles(request, request.options.grow_obstacles ? request.options.obstacle_growth_radius : grow_obstacles_);
+        growObstacles(requests, obstacleGrowthRadius(*requests.front()));
     }
 
-    if(map_pub.getNumSubscribers() > 0) {
-        nav_msgs::OccupancyGrid map_viz;
-        map_viz.header.stamp = ros::Time::now();
-        map_viz.header.frame_id = world_frame_;
-        map_viz.info.origin.position.x = map_info->getOrigin().x;
-        map_viz.info.origin.position.y = map_info->getOrigin().y;
-        map_viz.info.resolution = map_info->getResolution();
-        map_viz.info.width = map_info->getWidth();
-        map_viz.info.height = map_info->getHeight();
+    if(map_pub.getNumSubscribers() > 0 && diagnostics_.accepts(PlannerDiagnostics::Channel::MAP)) {
+        nav_msgs::OccupancyGridPtr map_viz(new nav_msgs::OccupancyGrid);
+        map_viz->header.stamp = ros::Time::now();
+        map_viz->header.frame_id = world_frame_;
+        map_viz->info.origin.position.x = map_info->getOrigin().x;
+        map_viz->info.origin.position.y = map_info->getOrigin().y;
+        map_viz->info.resolution = map_info->getResolution();
+        map_viz->info.width = map_info->getWidth();
+        map_viz->info.height = map_info->getHeight();
 
         std::size_t n = map_info->getWidth() * map_info->getHeight() * sizeof(unsigned char);
-        map_viz.data.resize(n);
-        int8_t* data = map_viz.data.data();
-        //std::memcpy(&map_viz.data.at(0), map_info->getData(), n);
-        for(int y = 0, h = map_info->getHeight(); y < h; ++y) {
-            for(int x = 0, w = map_info->getWidth(); x < w; ++x, ++data) {
+        map_viz->data.resize(n);
+        int8_t* data = map_viz->data.data();
+        if(use_collision_gridmap_) {
+            // the collision grid map checks the robot footprint, not only the cell value
+            for(int y = 0, h = map_info->getHeight(); y < h; ++y) {
+                for(int x = 0, w = map_info->getWidth(); x < w; ++x, ++data) {
 
-                *data = map_info->isFree(x,y) ? 255 : 0;
+                    *data = map_info->isFree(x,y) ? 255 : 0;
+                }
             }
+            diagnostics_.pushMap(map_viz, false, 0);
+
+        } else {
+            // converted by the diagnostics thread
+            std::memcpy(data, map_info->getData(), n);
+            diagnostics_.pushMap(map_viz, true, is_cost_map_ ? 253 : freeThreshold_);
         }
-        map_pub.publish(map_viz);
     }
 
     if(pre_process_) {
@@ -589,8 +1014,7 @@ void Planner::preprocess(const path_msgs::PlanPathGoal& request)
         int h = map_info->getHeight();
         int w = map_info->getWidth();
         cv::Mat map(h, w, CV_8UC1, map_info->getData());
-        cost_map.data.resize(h*w);
-        cv::Mat costmap(h, w, CV_8UC1, cost_map.data.data());
+        cv::Mat costmap;
         map.copyTo(costmap);
 
         //    cv::Mat unknown_mask;
@@ -612,13 +1036,30 @@ void Planner::preprocess(const path_msgs::PlanPathGoal& request)
         costmap = cv::max(0, 98 - costmap);
         //    costmap.setTo(50, unknown_mask);
 
-        cv::imwrite("costmap.png", costmap);
+        // only start a new revision (and invalidate the cost gradient) if the costs have changed
+        bool resized = cost_map.data.size() != std::size_t(h*w);
+        cost_map.data.resize(h*w);
+        cv::Mat current_costmap(h, w, CV_8UC1, cost_map.data.data());
+        if(resized || cv::countNonZero(costmap != current_costmap) > 0) {
+            costmap.copyTo(current_costmap);
+            ++cost_map_revision_;
+        }
+
+        if(published_cost_map_revision_ != cost_map_revision_) {
+            if(!diagnostics_.enabled()) {
+                // the cost map is published even without the diagnostics thread, only once per revision
+                cost_pub.publish(cost_map);
+                published_cost_map_revision_ = cost_map_revision_;
 
-        cost_pub.publish(cost_map);
+            } else if(diagnostics_.accepts(PlannerDiagnostics::Channel::COST_MAP)) {
+                diagnostics_.pushCostMap(boost::make_shared<nav_msgs::OccupancyGrid>(cost_map));
+                published_cost_map_revision_ = cost_map_revision_;
+            }
+        }
     }
 }
 
-path_msgs::PathSequence Planner::postprocess(const path_msgs::PathSequence& path)
+path_msgs::PathSequence Planner::postprocess(const path_msgs::PathSequence& path, bool send_feedback)
 {
     boost::lock_guard<boost::mutex> lock(map_mutex);
 
@@ -626,39 +1067,52 @@ path_msgs::PathSequence Planner::postprocess(const path_msgs::PathSequence& path
 
     ROS_DEBUG("postprocessing");
 
-    feedback(path_msgs::PlanPathFeedback::STATUS_POST_PROCESSING);
+    if(send_feedback) {
+        feedback(path_msgs::PlanPathFeedback::STATUS_POST_PROCESSING);
+    }
+
+    std::vector<path_msgs::ProcessingTime> timings;
+    auto stage_done = [&](const std::string& stage) {
+        path_msgs::ProcessingTime t;
+        t.stage = stage;
+        t.duration_ms = sw.msElapsed();
+        timings.push_back(t);
+        ROS_DEBUG_STREAM(stage << " took " << t.duration_ms << "ms");
+        sw.restart();
+    };
 
-    path_msgs::PathSequence working_copy = path;
+    PathBuffer& working_copy = postprocess_buffer_;
+    working_copy.assign(path);
+    stage_done("conversion");
 
     //    path_msgs::PathSequence simplified_path = simplifyPath(path);
     //    ROS_INFO_STREAM("simplifying took " << sw.msElapsed() << "ms");
 
     if(post_process_optimize_cost_) {
-        sw.restart();
-        working_copy = optimizePathCost(working_copy);
-        ROS_DEBUG_STREAM("optimizing cost took " << sw.msElapsed() << "ms");
+        optimizePathCost(working_copy);
+        stage_done("optimizing cost");
     }
 
-    sw.restart();
-    path_msgs::PathSequence interpolated_path = interpolatePath(working_copy, 0.5);
-    ROS_DEBUG_STREAM("interpolation took " << sw.msElapsed() << "ms");
+    interpolatePath(working_copy, 0.5);
+    stage_done("interpolation");
 
+    smoothPath(working_copy, 0.6, 0.15);
+    stage_done("smoothing");
 
-    sw.restart();
-    path_msgs::PathSequence smoothed_path = smoothPath(interpolated_path, 0.6, 0.15);
-    ROS_DEBUG_STREAM("smoothing took " << sw.msElapsed() << "ms");
+    interpolatePath(working_copy, 0.1);
+    stage_done("final interpolation");
 
+    smoothPath(working_copy, 2.0, 0.4);
+    stage_done("final smoothing");
 
-    sw.restart();
-    path_msgs::PathSequence final_interpolated_path = interpolatePath(smoothed_path, 0.1);
-    ROS_DEBUG_STREAM("final interpolation took " << sw.msElapsed() << "ms");
+    path_msgs::PathSequence result = working_copy.toMsg();
+    stage_done("message conversion");
 
+    if(send_feedback) {
+        feedback(path_msgs::PlanPathFeedback::STATUS_POST_PROCESSING, timings);
+    }
 
-    sw.restart();
-    path_msgs::PathSequence final_smoothed_path = smoothPath(final_interpolated_path, 2.0, 0.4);
-    ROS_DEBUG_STREAM("final smoothing took " << sw.msElapsed() << "ms");
-
-    return final_smoothed_path;
+    return result;
 }
 
 
@@ -693,75 +1147,162 @@ tf::StampedTransform Planner::lookupTransform(const std::string& from, const std
 }
 
 
-path_msgs::PathSequence Planner::doPlan(const path_msgs::PlanPathGoal &request)
+path_msgs::PathSequence Planner::doPlan(const path_msgs::PlanPathGoal &request, const CancellationToken::Ptr& token,
+                                        const ros::Time& search_deadline, const ros::Time& deadline, bool preliminary)
 {
     if(!supportsGoalType(request.goal.type)) {
         ROS_FATAL_STREAM("requested goal type " << request.goal.type << " is not supported.");
         return empty();
     }
 
-    ROS_DEBUG("starting search");
+    if(token->isCancelled()) {
+        return path_msgs::PathSequence();
+    }
+
+    ROS_DEBUG_STREAM("starting " << (preliminary ? "preliminary " : "") << "search");
 
     feedback(path_msgs::PlanPathFeedback::STATUS_PLANNING);
 
-    boost::thread worker(boost::bind(&Planner::planThreaded, this, request));
-    ros::Rate spin(10);
-    ros::Time start_time = ros::Time::now();
-    ros::Duration max_search_time(std::max(request.options.max_search_duration, 40.f));
+    boost::unique_lock<boost::mutex> lock(worker_mutex_);
+
+    // a cancelled search might still be unwinding
+    while(worker_busy_) {
+        worker_done_.wait(lock);
+    }
+
+    worker_request_ = request;
+    worker_token_ = token;
+    worker_search_deadline_ = search_deadline;
+    worker_preliminary_ = preliminary;
+    worker_has_job_ = true;
+    worker_busy_ = true;
+    worker_wakeup_.notify_one();
 
-    while(ros::ok()) {
+    while(worker_busy_) {
         ROS_INFO_STREAM_THROTTLE(2, "still planning");
-        bool timeout = start_time + max_search_time < ros::Time::now();
+        bool timeout = deadline < ros::Time::now();
         if(timeout){
             ROS_ERROR("search timed out");
         }
-        if(server_.isPreemptRequested() || timeout) {
+        if(!ros::ok() || token->isCancelled() || server_.isPreemptRequested() || timeout) {
             ROS_INFO_STREAM("preempted path planner");
-            return path_msgs::PathSequence();
+            token->cancel();
 
-        } else {
-            bool running;
-            thread_mutex.lock();
-            running = thread_running;
-            thread_ = &worker;
-            thread_mutex.unlock();
-
-            if(!running) {
-                worker.join();
-                break;
+            // give the search the chance to notice the cancellation and to release the map
+            for(int i = 0; i < 5 && worker_busy_; ++i) {
+                worker_done_.timed_wait(lock, boost::posix_time::milliseconds(100));
             }
+            return path_msgs::PathSequence();
         }
-        spin.sleep();
+
+        // woken up early when the search finishes or is preempted
+        worker_done_.timed_wait(lock, boost::posix_time::milliseconds(100));
     }
 
     ROS_DEBUG_STREAM("sub-planner done or aborted");
 
-    thread_mutex.lock();
-    path_msgs::PathSequence path = thread_result;
-    thread_mutex.unlock();
+    return worker_result_;
+}
+
+void Planner::planningWorker()
+{
+    boost::unique_lock<boost::mutex> lock(worker_mutex_);
+
+    while(true) {
+        while(!worker_has_job_ && !worker_shutdown_) {
+            worker_wakeup_.wait(lock);
+        }
+        if(worker_shutdown_) {
+            return;
+        }
+
+        worker_has_job_ = false;
+        path_msgs::PlanPathGoal request = worker_request_;
+        CancellationToken::Ptr token = worker_token_;
+        ros::Time search_deadline = worker_search_deadline_;
+        bool preliminary = worker_preliminary_;
+
+        lock.unlock();
+        path_msgs::PathSequence path = planThreaded(request, token, search_deadline, preliminary);
+        lock.lock();
+
+        worker_result_ = path;
+        worker_busy_ = false;
+        worker_done_.notify_all();
+    }
+}
+
+path_msgs::PathSequence Planner::planThreaded(const path_msgs::PlanPathGoal &goal, const CancellationToken::Ptr &token,
+                                              const ros::Time& search_deadline, bool preliminary)
+{
+    // the map lock is released when the search unwinds after a cancellation
+    boost::lock_guard<boost::mutex> lock(map_mutex);
+    search_deadline_ = search_deadline;
+
+    path_msgs::PathSequence path = empty();
+    try {
+        if(preliminary) {
+            planning_token_ = token;
+            path = planPreliminary(goal);
+        } else {
+            path = planImpl(goal, token);
+        }
+
+    } catch(const PlanningCancelledException& e) {
+        ROS_WARN_STREAM("search has been cancelled");
+
+    } catch(const std::exception& e) {
+        ROS_ERROR_STREAM("search failed: " << e.what());
+    }
+
+    // batch queries have no shared search time
+    search_deadline_ = ros::Time();
 
     return path;
 }
 
-void Planner::planThreaded(const path_msgs::PlanPathGoal &goal)
+void Planner::checkCancelled() const
 {
-    thread_mutex.lock();
-    thread_running = true;
-    thread_mutex.unlock();
+    if(planning_token_) {
+        planning_token_->check();
+    }
+}
 
-    path_msgs::PathSequence path;
-    {
-        boost::lock_guard<boost::mutex> lock(map_mutex);
-        path = planImpl(goal);
+bool Planner::isCancelled() const
+{
+    return planning_token_ && planning_token_->isCancelled();
+}
+
+double Planner::searchTimeLimit(const path_msgs::PlanPathGoal &request) const
+{
+    double limit = request.options.max_search_duration;
+    if(limit > 0.0 && !search_deadline_.isZero()) {
+        // a search without time left still gets a millisecond, a limit of 0 means no limit
+        limit = std::max(0.001, (search_deadline_ - ros::Time::now()).toSec());
     }
+    return limit;
+}
 
-    thread_mutex.lock();
-    thread_result = path;
-    thread_running = false;
-    thread_mutex.unlock();
+path_msgs::PathSequence Planner::planImpl(const path_msgs::PlanPathGoal &request, const CancellationToken::Ptr &token)
+{
+    planning_token_ = token;
+
+    return dispatchRequest(request);
+}
+
+path_msgs::PathSequence Planner::planQuery(const path_msgs::PlanPathGoal &request)
+{
+    // implementations are not required to be reentrant
+    boost::lock_guard<boost::mutex> lock(query_mutex_);
+    return dispatchRequest(request);
 }
 
-path_msgs::PathSequence Planner::planImpl(const path_msgs::PlanPathGoal &request)
+path_msgs::PathSequence Planner::planPreliminary(const path_msgs::PlanPathGoal &/*request*/)
+{
+    return empty();
+}
+
+path_msgs::PathSequence Planner::dispatchRequest(const path_msgs::PlanPathGoal &request)
 {
     geometry_msgs::PoseStamped start = request.use_start ? request.start : lookupPose();
     lib_path::Pose2d from_world, from_map;
@@ -815,28 +1356,26 @@ void Planner::transformPose(const geometry_msgs::PoseStamped& pose, lib_path::Po
     }
 }
 
-void Planner::subdividePath(path_msgs::DirectionalPath &result, geometry_msgs::PoseStamped low, geometry_msgs::PoseStamped up, double max_distance) {
-    double dx = low.pose.position.x - up.pose.position.x;
-    double dy = low.pose.position.y - up.pose.position.y;
+void Planner::subdividePath(PathBuffer::Segment &result,
+                            double low_x, double low_y, double low_theta,
+                            double up_x, double up_y, double up_theta,
+                            double max_distance) {
+    double dx = low_x - up_x;
+    double dy = low_y - up_y;
     double distance = std::sqrt(dx*dx + dy*dy);
 
     if(distance > max_distance) {
         // split half way between the lower and the upper node
-        geometry_msgs::PoseStamped halfway(low);
-        halfway.pose.position.x += (up.pose.position.x - low.pose.position.x) / 2.0;
-        halfway.pose.position.y += (up.pose.position.y - low.pose.position.y) / 2.0;
-
-        double up_y = tf::getYaw(up.pose.orientation);
-        double low_y = tf::getYaw(low.pose.orientation);
-
-        halfway.pose.orientation = tf::createQuaternionMsgFromYaw((up_y + low_y) / 2.0);
+        double half_x = low_x + (up_x - low_x) / 2.0;
+        double half_y = low_y + (up_y - low_y) / 2.0;
+        double half_theta = (up_theta + low_theta) / 2.0;
 
         // first recursive descent in lower part
-        subdividePath(result, low, halfway, max_distance);
+        subdividePath(result, low_x, low_y, low_theta, half_x, half_y, half_theta, max_distance);
         // then add the half way point
-        result.poses.push_back(halfway);
+        result.push_back(half_x, half_y, half_theta);
         // then descent in upper part
-        subdividePath(result, halfway, up, max_distance);
+        subdividePath(result, half_x, half_y, half_theta, up_x, up_y, up_theta, max_distance);
     }
 }
 
@@ -888,49 +1427,45 @@ path_msgs::PathSequence Planner::simplifyPath(const path_msgs::PathSequence &pat
     return result;
 }
 
-path_msgs::PathSequence Planner::interpolatePath(const path_msgs::PathSequence &path_raw, double max_distance)
+void Planner::interpolatePath(PathBuffer &path, double max_distance)
 {
-    path_msgs::PathSequence result;
-    result.header = path_raw.header;
-
-
-    for(const path_msgs::DirectionalPath& path : path_raw.paths) {
-        result.paths.emplace_back();
-        path_msgs::DirectionalPath& segment = result.paths.back();
-
-        segment.header = path.header;
-        segment.forward = path.forward;
+    for(PathBuffer::Segment& segment : path.segments) {
+        unsigned n = segment.size();
+        if(n == 0) {
+            continue;
+        }
 
-        unsigned n = path.poses.size();
+        // build the interpolated segment in the scratch buffer and swap it in afterwards
+        PathBuffer::Segment& result = interpolation_buffer_;
+        result.clear();
+        result.reserve(n);
 
-        segment.poses.push_back(path.poses[0]);
+        result.push_back(segment.x[0], segment.y[0], segment.theta[0]);
 
         for(unsigned i = 1; i < n; ++i){
-            const geometry_msgs::PoseStamped* current = &path.poses[i];
-
             // split the segment, iff it is to large
-            subdividePath(segment, segment.poses.back(), *current, max_distance);
+            subdividePath(result,
+                          result.x.back(), result.y.back(), result.theta.back(),
+                          segment.x[i], segment.y[i], segment.theta[i],
+                          max_distance);
 
             // add the end of the segment (is not done, when splitting)
-            segment.poses.push_back(*current);
+            result.push_back(segment.x[i], segment.y[i], segment.theta[i]);
         }
-    }
 
-    return result;
+        segment.x.swap(result.x);
+        segment.y.swap(result.y);
+        segment.theta.swap(result.theta);
+    }
 }
 
-path_msgs::PathSequence Planner::smoothPath(const path_msgs::PathSequence& path_raw, double weight_data, double weight_smooth, double tolerance) {
-    path_msgs::PathSequence result;
-    result.header = path_raw.header;
-
-    for(const path_msgs::DirectionalPath& path : path_raw.paths) {
-        path_msgs::DirectionalPath smoothed_segment = smoothPathSegment(path, weight_data, weight_smooth, tolerance);
-        result.paths.push_back(smoothed_segment);
+void Planner::smoothPath(PathBuffer& path, double weight_data, double weight_smooth, double tolerance) {
+    for(PathBuffer::Segment& segment : path.segments) {
+        smoothPathSegment(segment, weight_data, weight_smooth, tolerance);
     }
-    return result;
 }
 
-void Planner::publishGradient(const cv::Mat& gx, const cv::Mat& gy)
+void Planner::publishGradient()
 {
     visualization_msgs::Marker gradient_arrow;
     gradient_arrow.header.frame_id = world_frame_;
@@ -956,14 +1491,20 @@ void Planner::publishGradient(const cv::Mat& gx, const cv::Mat& gy)
     double oy = o.y;
 
     int step = 5;
-    for(int y = 0; y < gx.rows; y += step) {
-        for(int x = 0; x < gx.cols; x += step) {
+    for(int y = 0; y < cost_gradient_.height(); y += step) {
+        for(int x = 0; x < cost_gradient_.width(); x += step) {
+            if(!cost_gradient_.isComputed(x, y)) {
+                continue;
+            }
+
             auto arrow = gradient_arrow;
             arrow.pose.position.x = x * res + ox;
             arrow.pose.position.y = y * res + oy;
 
-            int grad_x = -gx.at<float>(y, x);
-            int grad_y = -gy.at<float>(y, x);
+            float gx, gy;
+            cost_gradient_.get(x, y, gx, gy);
+            int grad_x = -gx;
+            int grad_y = -gy;
 
             double magnitude = hypot(grad_x, grad_y) / 255.0;
             arrow.scale.x = magnitude * 10.0;
@@ -983,111 +1524,48 @@ void Planner::publishGradient(const cv::Mat& gx, const cv::Mat& gy)
     viz_array_pub.publish(array);
 }
 
-void Planner::calculateGradient(cv::Mat &gx, cv::Mat &gy)
-{
-    const nav_msgs::OccupancyGrid& cost = cost_map;
-
-    cv::Mat cost_mat(cost.info.height, cost.info.width, CV_8UC1, (uint8_t*)(cost.data.data()));
-
-    /// Sobel Version
-    //    double s = 1e-2;
-    //    cv::Sobel(cost_mat, gx, CV_32F, 1, 0, 5, s);
-    //    cv::Sobel(cost_mat, gy, CV_32F, 0, 1, 5, s);
-
-    /// Minimum Search
-    gx = cv::Mat(cost.info.height, cost.info.width, CV_32FC1, cv::Scalar::all(0));
-    gy = cv::Mat(cost.info.height, cost.info.width, CV_32FC1, cv::Scalar::all(0));
-
-    int d = 5;
-
-    for(int y = 0; y < gx.rows; ++y) {
-        for(int x = 0; x < gx.cols; ++x) {
-            int cost = cost_mat.at<uchar>(y,x);
-
-            if(cost == 0) {
-                continue;
-            }
-
-            int min_x, min_y;
-            int min_cost = 512;
-            float min_dist = 2 * d;
-
-            int starty = std::max(0, y - d);
-            int endy = std::min(gx.rows - 1, y + d);
-            for(int ny = starty; ny < endy; ++ny) {
-
-                int startx = std::max(0, x - d);
-                int endx = std::min(gx.rows - 1, x + d);
-                for(int nx = startx; nx < endx; ++nx) {
-
-                    int ncost = cost_mat.at<uchar>(ny,nx);
-                    float dist_n = std::hypot(float(x-nx), float(y-ny));
-                    if(ncost < min_cost || (ncost == min_cost && dist_n < min_dist)) {
-                        min_x = nx;
-                        min_y = ny;
-
-                        min_cost = ncost;
-                        min_dist = dist_n;
-                    }
-                }
-            }
-
-            if(min_cost < 512) {
-                int dx = (x - min_x);
-                int dy = (y - min_y);
-
-                if(dx != 0 || dy != 0) {
-                    float norm = std::hypot((float) dx, (float) dy);
-                    float len = cost / 10.0;// std::abs(min_cost - cost) / 10.0;
-
-                    float f = len / norm;// / norm;
-
-                    dx *= f;
-                    dy *= f;
-
-                    gx.at<float>(y,x) = dx;
-                    gy.at<float>(y,x) = dy;
-                }
-            }
-        }
-    }
-}
-
-path_msgs::PathSequence Planner::optimizePathCost(const path_msgs::PathSequence& path_raw) {
+void Planner::optimizePathCost(PathBuffer& path) {
     if(!map_info) {
-        return path_raw;
+        return;
     }
 
-    path_msgs::PathSequence new_path(path_raw);
-
-    cv::Mat gx, gy;
-    calculateGradient(gx, gy);
-
-    if(publish_gradient_) {
-        publishGradient(gx, gy);
+    unsigned w = cost_map.info.width;
+    unsigned h = cost_map.info.height;
+    if(cost_map.data.size() != w * h) {
+        ROS_WARN("cannot optimize path cost, there is no cost map");
+        return;
     }
 
+    // the gradient is evaluated lazily, only where the optimization queries it
+    cost_gradient_.setCostMap((const uint8_t*) cost_map.data.data(), w, h, cost_map_revision_);
+
     double last_change = -2 * cost_optimization_tolerance;
     double change = 0;
 
     int offset = 2;
 
 
-    for(path_msgs::DirectionalPath& segment : new_path.paths) {
-        unsigned n = segment.poses.size();
-        path_msgs::DirectionalPath optimized_segment = segment;
+    for(PathBuffer::Segment& segment : path.segments) {
+        unsigned n = segment.size();
+        if(n <= (unsigned) 2 * offset) {
+            continue;
+        }
+
+        // the original positions are the data term, the segment is optimized in place
+        const std::vector<double> original_x = segment.x;
+        const std::vector<double> original_y = segment.y;
 
-        std::vector<double> gradients_x(segment.poses.size());
-        std::vector<double> gradients_y(segment.poses.size());
-        std::vector<double> magnitudes(segment.poses.size());
+        std::vector<double> gradients_x(n);
+        std::vector<double> gradients_y(n);
+        std::vector<double> magnitudes(n);
 
-        std::vector<double> dist_to_start(segment.poses.size());
-        std::vector<double> dist_to_goal(segment.poses.size());
+        std::vector<double> dist_to_start(n);
+        std::vector<double> dist_to_goal(n);
 
-        std::vector<double> X(segment.poses.size());
-        std::vector<double> Y(segment.poses.size());
+        std::vector<double> X(n);
+        std::vector<double> Y(n);
 
-        std::vector<double> lengths(segment.poses.size()-1);
+        std::vector<double> lengths(n-1);
 
         while(change > last_change + cost_optimization_tolerance) {
             last_change = change;
@@ -1095,8 +1573,7 @@ path_msgs::PathSequence Planner::optimizePathCost(const path_msgs::PathSequence&
 
             for(unsigned i = 0; i < n; ++i) {
                 unsigned int x, y;
-                Pose2d pt_i = convert(optimized_segment.poses[i]);
-                map_info->point2cell(pt_i.x, pt_i.y, x, y);
+                map_info->point2cell(segment.x[i], segment.y[i], x, y);
                 X[i] = x;
                 Y[i] = y;
             }
@@ -1118,8 +1595,10 @@ path_msgs::PathSequence Planner::optimizePathCost(const path_msgs::PathSequence&
             for(unsigned i = 0; i < n; ++i){
                 unsigned int x = X[i];
                 unsigned int y = Y[i];
-                int grad_x = gx.at<float>(y, x);
-                int grad_y = gy.at<float>(y, x);
+                float gx, gy;
+                cost_gradient_.get(x, y, gx, gy);
+                int grad_x = gx;
+                int grad_y = gy;
                 double magnitude = hypot(grad_x, grad_y) / 255.0;
                 gradients_x[i] = grad_x;
                 gradients_y[i] = grad_y;
@@ -1127,10 +1606,10 @@ path_msgs::PathSequence Planner::optimizePathCost(const path_msgs::PathSequence&
             }
 
             for(unsigned i = offset; i < n-offset; ++i){
-                Pose2d path_i = convert(segment.poses[i]);
-                Pose2d new_path_i = convert(optimized_segment.poses[i]);
-                Pose2d new_path_ip1 = convert(optimized_segment.poses[i+1]);
-                Pose2d new_path_im1 = convert(optimized_segment.poses[i-1]);
+                Pose2d path_i(original_x[i], original_y[i], segment.theta[i]);
+                Pose2d new_path_i(segment.x[i], segment.y[i], segment.theta[i]);
+                Pose2d new_path_ip1(segment.x[i+1], segment.y[i+1], segment.theta[i+1]);
+                Pose2d new_path_im1(segment.x[i-1], segment.y[i-1], segment.theta[i-1]);
 
                 double dist_border = std::min(dist_to_start[i], dist_to_goal[i]);
                 double border_damp = 1.0 + 5.0 / (0.01 + (dist_border / 5.0));
@@ -1160,19 +1639,21 @@ path_msgs::PathSequence Planner::optimizePathCost(const path_msgs::PathSequence&
                 Pose2d deltaSmooth =  cost_optimization_weight_smooth * (new_path_ip1 + new_path_im1 - 2* new_path_i);
                 new_path_i = new_path_i + deltaSmooth;
 
-                optimized_segment.poses[i].pose.position.x = new_path_i.x;
-                optimized_segment.poses[i].pose.position.y = new_path_i.y;
+                segment.x[i] = new_path_i.x;
+                segment.y[i] = new_path_i.y;
 
                 change += deltaData.distance_to_origin()
                         + deltaSmooth.distance_to_origin()
                         + deltaCost.distance_to_origin();
             }
         }
-
-        segment = optimized_segment;
     }
 
-    return new_path;
+    ROS_DEBUG_STREAM("cost gradient evaluated at " << cost_gradient_.cellsEvaluated() << " of " << (w * h) << " cells");
+
+    if(publish_gradient_) {
+        publishGradient();
+    }
 }
 
 Pose2d Planner::convert(const geometry_msgs::PoseStamped& rhs)
@@ -1182,91 +1663,186 @@ Pose2d Planner::convert(const geometry_msgs::PoseStamped& rhs)
 
 void Planner::laserCallback(const sensor_msgs::LaserScanConstPtr &scan, bool front)
 {
+    boost::lock_guard<boost::mutex> lock(sensor_mutex_);
     if(front) {
-        scan_front = *scan;
+        scan_front = scan;
     } else {
-        scan_back = *scan;
+        scan_back = scan;
     }
 }
 
-void Planner::integrateLaserScan(const sensor_msgs::LaserScan &scan)
+Utils_PointProjection::CellTransform Planner::sensorToCell(const tf::Transform &sensor_to_world) const
+{
+    // cell = R(-yaw) * (world - origin) / resolution, cf. nav_msgs/MapMetaData
+    const nav_msgs::MapMetaData& info = active_snapshot_->info;
+    double c = std::cos(tf::getYaw(info.origin.orientation)) / info.resolution;
+    double s = std::sin(tf::getYaw(info.origin.orientation)) / info.resolution;
+
+    const tf::Matrix3x3& B = sensor_to_world.getBasis();
+    double bx = sensor_to_world.getOrigin().x() - info.origin.position.x;
+    double by = sensor_to_world.getOrigin().y() - info.origin.position.y;
+
+    Utils_PointProjection::CellTransform t;
+    t.xx = c * B[0][0] + s * B[1][0];
+    t.xy = c * B[0][1] + s * B[1][1];
+    t.xz = c * B[0][2] + s * B[1][2];
+    t.x0 = c * bx + s * by;
+    t.yx = -s * B[0][0] + c * B[1][0];
+    t.yy = -s * B[0][1] + c * B[1][1];
+    t.yz = -s * B[0][2] + c * B[1][2];
+    t.y0 = -s * bx + c * by;
+    return t;
+}
+
+void Planner::integrateLaserScan(const sensor_msgs::LaserScan &scan, ScanTable& table)
 {
     tf::StampedTransform trafo = lookupTransform(world_frame_, scan.header.frame_id, scan.header.stamp);
+    Utils_PointProjection::CellTransform t = sensorToCell(trafo);
+
+    uint8_t OBSTACLE = is_cost_map_ ? 254 : 100;
+
+    std::size_t total = scan.ranges.size();
+    if(table.angle_min != scan.angle_min || table.angle_increment != scan.angle_increment || table.cos.size() != total) {
+        table.angle_min = scan.angle_min;
+        table.angle_increment = scan.angle_increment;
+        table.cos.resize(total);
+        table.sin.resize(total);
+        double angle = scan.angle_min;
+        for(std::size_t i = 0; i < total; ++i) {
+            table.cos[i] = std::cos(angle);
+            table.sin[i] = std::sin(angle);
+            angle += scan.angle_increment;
+        }
+    }
 
-    int OBSTACLE = is_cost_map_ ? 254 : 100;
+    uint8_t* grid = map_info->getData();
+    int w = map_info->getWidth();
+    int h = map_info->getHeight();
 
-    double angle = scan.angle_min;
-    for(std::size_t i = 0, total = scan.ranges.size(); i < total; ++i) {
+    float x[POINT_BATCH], y[POINT_BATCH], z[POINT_BATCH] = {};
+    std::size_t n = 0;
+    float max_range = 0.f;
+    for(std::size_t i = 0; i < total; ++i) {
         const float& range = scan.ranges[i];
         if(range > scan.range_min && range < (scan.range_max - 1.0) && range == range) {
-
-            tf::Vector3 pt_laser(std::cos(angle) * range, std::sin(angle) * range, 0);
-            tf::Vector3 pt_map = trafo * pt_laser;
-
-            unsigned int x,y;
-            if(map_info->point2cell(pt_map.x(), pt_map.y(), x, y)) {
-                map_info->setValue(x,y, OBSTACLE);
+            max_range = std::max(max_range, range);
+            x[n] = table.cos[i] * range;
+            y[n] = table.sin[i] * range;
+            if(++n == POINT_BATCH) {
+                Utils_PointProjection::markCells(t, x, y, z, n, grid, w, h, OBSTACLE);
+                n = 0;
             }
         }
-
-        angle += scan.angle_increment;
     }
+    Utils_PointProjection::markCells(t, x, y, z, n, grid, w, h, OBSTACLE);
+
+    const float min[3] = { -max_range, -max_range, 0.f };
+    const float max[3] = { max_range, max_range, 0.f };
+    int x0, y0, x1, y1;
+    Utils_PointProjection::cellBounds(t, min, max, w, h, x0, y0, x1, y1);
+    markModified(x0, y0, x1, y1);
 }
 
-void Planner::growObstacles(const path_msgs::PlanPathGoal& request, double radius)
+double Planner::obstacleGrowthRadius(const path_msgs::PlanPathGoal& request) const
 {
-    lib_path::Pose2d from_world, from_map;
-    transformPose(request.use_start ? request.start : lookupPose(), from_world, from_map);
-    lib_path::Pose2d to_world, to_map;
-    transformPose(request.goal.pose, to_world, to_map);
+    return request.options.grow_obstacles ? request.options.obstacle_growth_radius : grow_obstacles_;
+}
 
+void Planner::growObstacles(const std::vector<const path_msgs::PlanPathGoal*>& requests, double radius)
+{
     cv::Mat map(map_info->getHeight(), map_info->getWidth(), CV_8UC1, map_info->getData());
-    cv::Mat working;
-    map.copyTo(working);
 
+    // only the neighborhood of cells that changed since the last request is dilated again
     int r = radius / map_info->getResolution();
-    int iterations = 1;
-    cv::Mat element = cv::getStructuringElement( cv::MORPH_ELLIPSE,
-                                                 cv::Size( 2*r + 1, 2*r+1 ),
-                                                 cv::Point( r, r ) );
-    cv::dilate(working, working, element, cv::Point(-1,-1), iterations);
-
+    const cv::Mat& working = obstacle_inflation_.update(map, r);
+    ROS_DEBUG_STREAM("obstacle inflation updated " << obstacle_inflation_.cellsUpdated() << " of " << map.total() << " cells");
 
     cv::Mat mask(working.rows, working.cols, CV_8UC1, cv::Scalar::all(255));
 
-    cv::circle(mask, cv::Point(from_map.x, from_map.y), r, cv::Scalar::all(0), CV_FILLED);
-    cv::circle(mask, cv::Point(to_map.x, to_map.y), r, cv::Scalar::all(0), CV_FILLED);
+    // start and goal of every request stay free
+    for(const path_msgs::PlanPathGoal* request : requests) {
+        lib_path::Pose2d from_world, from_map;
+        transformPose(request->use_start ? request->start : lookupPose(), from_world, from_map);
+        lib_path::Pose2d to_world, to_map;
+        transformPose(request->goal.pose, to_world, to_map);
+
+        cv::circle(mask, cv::Point(from_map.x, from_map.y), r, cv::Scalar::all(0), CV_FILLED);
+        cv::circle(mask, cv::Point(to_map.x, to_map.y), r, cv::Scalar::all(0), CV_FILLED);
+    }
 
 
     working.copyTo(map, mask);
+
+    // the inflated values are written into every cell outside of the mask
+    markModified(0, 0, map.cols, map.rows);
 }
 
 
 void Planner::cloudCallback(const sensor_msgs::PointCloud2ConstPtr& cloud)
 {
-    cloud_ = *cloud;
+    boost::lock_guard<boost::mutex> lock(sensor_mutex_);
+    cloud_ = cloud;
 }
 
 void Planner::integratePointCloud(const sensor_msgs::PointCloud2 &cloud)
 {
-    tf::StampedTransform trafo = lookupTransform(world_frame_, cloud.header.frame_id, cloud.header.stamp);
-
-    int OBSTACLE = is_cost_map_ ? 254 : 100;
-
-    pcl::PointCloud<pcl::PointXYZL>::Ptr ptr(new pcl::PointCloud<pcl::PointXYZL>());
-    pcl::fromROSMsg(cloud, *ptr);
-
-    for(pcl::PointCloud<pcl::PointXYZL>::const_iterator it = ptr->begin(); it != ptr->end(); ++it) {
-        const pcl::PointXYZL& pt = *it;
-
-        tf::Vector3 pt_cloud(pt.x, pt.y, pt.z);
-        tf::Vector3 pt_map = trafo * pt_cloud;
+    int offset[3] = { -1, -1, -1 };
+    for(const sensor_msgs::PointField& field : cloud.fields) {
+        int axis = field.name == "x" ? 0 : field.name == "y" ? 1 : field.name == "z" ? 2 : -1;
+        if(axis >= 0 && field.datatype == sensor_msgs::PointField::FLOAT32) {
+            offset[axis] = field.offset;
+        }
+    }
+    if(offset[0] < 0 || offset[1] < 0 || offset[2] < 0) {
+        ROS_WARN_STREAM_THROTTLE(5, "obstacle cloud has no float32 x, y and z fields, ignoring it");
+        return;
+    }
+    if(cloud.is_bigendian) {
+        ROS_WARN_STREAM_THROTTLE(5, "big endian obstacle clouds are not supported, ignoring it");
+        return;
+    }
 
-        unsigned int x,y;
-        if(map_info->point2cell(pt_map.x(), pt_map.y(), x, y)) {
-            map_info->setValue(x,y, OBSTACLE);
+    tf::StampedTransform trafo = lookupTransform(world_frame_, cloud.header.frame_id, cloud.header.stamp);
+    Utils_PointProjection::CellTransform t = sensorToCell(trafo);
+
+    uint8_t OBSTACLE = is_cost_map_ ? 254 : 100;
+
+    uint8_t* grid = map_info->getData();
+    int w = map_info->getWidth();
+    int h = map_info->getHeight();
+
+    // read the coordinates directly from the message buffer
+    float x[POINT_BATCH], y[POINT_BATCH], z[POINT_BATCH];
+    std::size_t n = 0;
+    // bounding box of the points, NaN coordinates are skipped by the comparisons
+    const float inf = std::numeric_limits<float>::infinity();
+    float min[3] = { inf, inf, inf };
+    float max[3] = { -inf, -inf, -inf };
+    for(std::size_t row = 0; row < cloud.height; ++row) {
+        const uint8_t* pt = &cloud.data[row * cloud.row_step];
+        for(std::size_t col = 0; col < cloud.width; ++col, pt += cloud.point_step) {
+            std::memcpy(&x[n], pt + offset[0], sizeof(float));
+            std::memcpy(&y[n], pt + offset[1], sizeof(float));
+            std::memcpy(&z[n], pt + offset[2], sizeof(float));
+            min[0] = std::min(min[0], x[n]);
+            min[1] = std::min(min[1], y[n]);
+            min[2] = std::min(min[2], z[n]);
+            max[0] = std::max(max[0], x[n]);
+            max[1] = std::max(max[1], y[n]);
+            max[2] = std::max(max[2], z[n]);
+            if(++n == POINT_BATCH) {
+                Utils_PointProjection::markCells(t, x, y, z, n, grid, w, h, OBSTACLE);
+                n = 0;
+            }
         }
     }
+    Utils_PointProjection::markCells(t, x, y, z, n, grid, w, h, OBSTACLE);
+
+    if(min[0] <= max[0] && min[1] <= max[1] && min[2] <= max[2]) {
+        int x0, y0, x1, y1;
+        Utils_PointProjection::cellBounds(t, min, max, w, h, x0, y0, x1, y1);
+        markModified(x0, y0, x1, y1);
+    }
 }
 
 void Planner::publish(const path_msgs::PathSequence &path, const path_msgs::PathSequence &path_raw)
@@ -1288,13 +1864,16 @@ void Planner::publish(const path_msgs::PathSequence &path, const path_msgs::Path
     }
 }
 
-path_msgs::DirectionalPath Planner::smoothPathSegment(const path_msgs::DirectionalPath& path, double weight_data, double weight_smooth, double tolerance)
+void Planner::smoothPathSegment(PathBuffer::Segment& path, double weight_data, double weight_smooth, double tolerance)
 {
-    path_msgs::DirectionalPath new_path(path);
-    new_path.header = path.header;
-    new_path.forward = path.forward;
+    int n = path.size();
+    if(n < 2) {
+        return;
+    }
 
-    int n = path.poses.size();
+    // the unsmoothed positions are the data term, the segment is smoothed in place
+    const std::vector<double> original_x = path.x;
+    const std::vector<double> original_y = path.y;
 
     double last_change = -2 * tolerance;
     double change = 0;
@@ -1306,10 +1885,10 @@ path_msgs::DirectionalPath Planner::smoothPathSegment(const path_msgs::Direction
         change = 0;
 
         for(int i = offset; i < n-offset; ++i){
-            Pose2d path_i = convert(path.poses[i]);
-            Pose2d new_path_i = convert(new_path.poses[i]);
-            Pose2d new_path_ip1 = convert(new_path.poses[i+1]);
-            Pose2d new_path_im1 = convert(new_path.poses[i-1]);
+            Pose2d path_i(original_x[i], original_y[i], path.theta[i]);
+            Pose2d new_path_i(path.x[i], path.y[i], path.theta[i]);
+            Pose2d new_path_ip1(path.x[i+1], path.y[i+1], path.theta[i+1]);
+            Pose2d new_path_im1(path.x[i-1], path.y[i-1], path.theta[i-1]);
 
             Pose2d deltaData = weight_data * (path_i - new_path_i);
             new_path_i = new_path_i + deltaData;
@@ -1317,20 +1896,18 @@ path_msgs::DirectionalPath Planner::smoothPathSegment(const path_msgs::Direction
             Pose2d deltaSmooth =  weight_smooth * (new_path_ip1 + new_path_im1 - 2* new_path_i);
             new_path_i = new_path_i + deltaSmooth;
 
-            new_path.poses[i].pose.position.x = new_path_i.x;
-            new_path.poses[i].pose.position.y = new_path_i.y;
+            path.x[i] = new_path_i.x;
+            path.y[i] = new_path_i.y;
 
             change += deltaData.distance_to_origin() + deltaSmooth.distance_to_origin();
         }
     }
 
     // update orientations
-    double a = tf::getYaw(new_path.poses[0].pose.orientation);
-    geometry_msgs::Pose current = new_path.poses[0].pose;
-    geometry_msgs::Pose next = new_path.poses[1].pose;
+    double a = path.theta[0];
 
-    double dx = next.position.x - current.position.x;
-    double dy = next.position.y - current.position.y;
+    double dx = path.x[1] - path.x[0];
+    double dy = path.y[1] - path.y[0];
 
     Eigen::Vector2d looking_dir_normalized(std::cos(a), std::sin(a));
     Eigen::Vector2d delta(dx, dy);
@@ -1340,20 +1917,14 @@ path_msgs::DirectionalPath Planner::smoothPathSegment(const path_msgs::Direction
     bool is_backward = (theta_diff > M_PI_2 || theta_diff < -M_PI_2) ;
 
     for(int i = 1; i < n-1; ++i){
-        Pose2d next = convert(new_path.poses[i+1]);
-        Pose2d prev = convert(new_path.poses[i-1]);
-
-        Pose2d delta = next - prev;
-        double angle = std::atan2(delta.y, delta.x);
+        double angle = std::atan2(path.y[i+1] - path.y[i-1], path.x[i+1] - path.x[i-1]);
 
         if(is_backward) {
             angle = MathHelper::AngleClamp(angle + M_PI);
         }
 
-        new_path.poses[i].pose.orientation = tf::createQuaternionMsgFromYaw(angle);
+        path.theta[i] = angle;
     }
-
-    return new_path;
 }
 
 path_msgs::PathSequence Planner::empty() const
@@ -1,13 +1,25 @@
 #ifndef PLANNER_NODE_H
 #define PLANNER_NODE_H
 
+/// COMPONENT
+#include "cost_gradient.h"
+#include "path_buffer.h"
+#include "cancellation_token.h"
+#include "heuristic_cache.h"
+#include "planner_diagnostics.h"
+#include "obstacle_inflation.h"
+#include "point_projection.h"
+#include "tiled_grid.h"
+
 /// PROJECT
 #include <cslibs_path_planning/common/SimpleGridMap2d.h>
 #include <cslibs_path_planning/common/Pose2d.h>
 #include <path_msgs/PlanPathAction.h>
+#include <path_msgs/PlanPathBatch.h>
 
 /// SYSTEM
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
 #include <tf/transform_listener.h>
 #include <nav_msgs/OccupancyGrid.h>
 #include <nav_msgs/Path.h>
@@ -15,6 +27,7 @@
 #include <sensor_msgs/LaserScan.h>
 #include <sensor_msgs/PointCloud2.h>
 #include <opencv2/core/core.hpp>
+#include <boost/thread.hpp>
 
 /**
  * @brief The Planner class is a base class for other planning algorithms
@@ -61,8 +74,41 @@ protected:
     /**
      * @brief plan is the interface for implementation classes
      * @param goal the requested goal message
+     * @param token cancels the search, checked via checkCancelled()
+     */
+    path_msgs::PathSequence planImpl (const path_msgs::PlanPathGoal &goal, const CancellationToken::Ptr& token);
+
+    /**
+     * @brief planQuery plans one query of a batch. All queries of a batch are planned concurrently on the same map.
+     *        The default implementation plans one query at a time, implementations with reentrant searches can override it.
+     * @param goal the requested goal message
+     */
+    virtual path_msgs::PathSequence planQuery(const path_msgs::PlanPathGoal &goal);
+
+    /**
+     * @brief planPreliminary finds a first feasible path for anytime requests, which is sent as feedback
+     *        before the final path is searched. It should be considerably faster than plan.
+     *        The default implementation finds no path.
+     * @param goal the requested goal message
+     */
+    virtual path_msgs::PathSequence planPreliminary(const path_msgs::PlanPathGoal &goal);
+
+    /**
+     * @brief checkCancelled throws a PlanningCancelledException, iff the running search has been cancelled.
+     *        Implementation classes should call this regularly during long searches.
      */
-    path_msgs::PathSequence planImpl (const path_msgs::PlanPathGoal &goal);
+    void checkCancelled() const;
+
+    /**
+     * @brief isCancelled is checkCancelled for searches that cannot be unwound with an exception
+     */
+    bool isCancelled() const;
+
+    /**
+     * @brief searchTimeLimit returns the time limit for a search of the request: options.max_search_duration,
+     *        reduced by the time that earlier searches of the same request have used (e.g. the preliminary search)
+     */
+    double searchTimeLimit(const path_msgs::PlanPathGoal &request) const;
 
     /**
      * @brief plan is the interface for implementation classes for 'non pose mode'
@@ -86,11 +132,10 @@ protected:
 
     /**
      * @brief interpolatePath interpolates segments of the given path, if their length exeeds the given maximum distance
-     * @param path path to interpolate
+     * @param path path to interpolate in place
      * @param max_distance maximum segment length
-     * @return interpolated path
      */
-    path_msgs::PathSequence interpolatePath(const path_msgs::PathSequence &path, double max_distance);
+    void interpolatePath(PathBuffer &path, double max_distance);
 
     /**
      * @brief simplifyPath uses heuristics to try to simplify the given path
@@ -102,20 +147,18 @@ protected:
 
     /**
      * @brief smoothPath smooths the given path
-     * @param path path to smooth
+     * @param path path to smooth in place
      * @param weight_data weight for data integrity
      * @param weight_smooth weight for smoothness
      * @param tolerance iteration stopping criterium
-     * @return smooted path
      */
-    path_msgs::PathSequence smoothPath(const path_msgs::PathSequence& path, double weight_data, double weight_smooth, double tolerance = 0.000001);
+    void smoothPath(PathBuffer& path, double weight_data, double weight_smooth, double tolerance = 0.000001);
 
     /**
-     * @brief optimizePathCost generates a new path based on <path> by performing gradient descent with the current costmap.
-     * @param path the path to optimize
-     * @return optimized path
+     * @brief optimizePathCost moves the given path by performing gradient descent with the current costmap.
+     * @param path the path to optimize in place
      */
-    path_msgs::PathSequence optimizePathCost(const path_msgs::PathSequence& path);
+    void optimizePathCost(PathBuffer& path);
 
     /**
      * @brief convert convert a ros pose to a lib_path::Pose
@@ -133,14 +176,21 @@ protected:
 protected:
     void transformPose(const geometry_msgs::PoseStamped& pose, lib_path::Pose2d& world, lib_path::Pose2d& map);
 
-    void preprocess(const path_msgs::PlanPathGoal& request);
-    path_msgs::PathSequence postprocess(const path_msgs::PathSequence& path);
+    void preprocess(const std::vector<const path_msgs::PlanPathGoal*>& requests, bool send_feedback);
+    path_msgs::PathSequence postprocess(const path_msgs::PathSequence& path, bool send_feedback = true);
 
     void preempt();
-    void feedback(int status);
+    void feedback(int status, const std::vector<path_msgs::ProcessingTime>& timings = {});
+    void feedbackPreliminaryPath(const path_msgs::PathSequence& path);
 
     path_msgs::PathSequence empty() const;
 
+    /**
+     * @brief holonomicHeuristic returns the cached cost-to-go field (in cells) of the static map for a goal cell
+     * @return nullptr, if the cache is disabled or has no field for the goal on the active map snapshot
+     */
+    HeuristicCache::Field::ConstPtr holonomicHeuristic(const lib_path::Pose2d& goal_map);
+
 protected:
     virtual bool supportsGoalType(int type) const = 0;
 
@@ -153,26 +203,98 @@ protected:
 
 
 private:
+    /**
+     * @brief The ScanTable struct caches the beam directions of a scan geometry
+     */
+    struct ScanTable
+    {
+        ScanTable() : angle_min(0.f), angle_increment(0.f) {}
+
+        float angle_min;
+        float angle_increment;
+        std::vector<float> cos;
+        std::vector<float> sin;
+    };
+
+    // points are transformed into the grid in batches of this size
+    enum { POINT_BATCH = 256 };
+
+    Utils_PointProjection::CellTransform sensorToCell(const tf::Transform& sensor_to_world) const;
+
     void laserCallback(const sensor_msgs::LaserScanConstPtr& scan, bool front);
-    void integrateLaserScan(const sensor_msgs::LaserScan &scan);
+    void integrateLaserScan(const sensor_msgs::LaserScan &scan, ScanTable& table);
 
     void cloudCallback(const sensor_msgs::PointCloud2ConstPtr& cloud);
     void integratePointCloud(const sensor_msgs::PointCloud2 &cloud);
 
-    void growObstacles(const path_msgs::PlanPathGoal &request, double radius);
+    void growObstacles(const std::vector<const path_msgs::PlanPathGoal*>& requests, double radius);
+    double obstacleGrowthRadius(const path_msgs::PlanPathGoal &request) const;
+
+    enum class MapConversion {
+        COST, OCCUPANCY_UNKNOWN, OCCUPANCY_RAW
+    };
+
+    /**
+     * @brief The MapSnapshot struct is an immutable version of the map.
+     *        Searches keep the snapshot they started with, while map updates create new versions.
+     */
+    struct MapSnapshot
+    {
+        typedef std::shared_ptr<const MapSnapshot> ConstPtr;
+
+        std_msgs::Header header;
+        nav_msgs::MapMetaData info;
+        bool is_cost_map;
+        MapConversion conversion;
+
+        // tiles are shared between snapshots, as long as they don't change
+        std::shared_ptr<const TiledGrid<int8_t>> raw;
+        std::shared_ptr<const TiledGrid<uint8_t>> data;
+
+        std::size_t revision;
+        std::size_t cells_updated;
+        ros::WallTime created;
+
+        // cells [x0, x1) x [y0, y1) changed with respect to the previous revision
+        unsigned changed_x0, changed_y0, changed_x1, changed_y1;
+    };
+
+    MapSnapshot::ConstPtr currentMapSnapshot();
+    void activateMapSnapshot(const MapSnapshot::ConstPtr& snapshot);
+    void markModified(int x0, int y0, int x1, int y1);
+    void updateHeuristicCache(const MapSnapshot& snapshot);
 
-    void calculateGradient(cv::Mat& gx, cv::Mat& gy);
-    void publishGradient(const cv::Mat &gx, const cv::Mat &gy);
+    static void convertMapRow(const int8_t* src, MapConversion conversion, uint8_t* dst, int len);
+
+    void publishGradient();
 
     path_msgs::PathSequence findPath(const path_msgs::PlanPathGoal &request);
+    bool prepareMap(const std::vector<const path_msgs::PlanPathGoal*>& requests, bool send_feedback);
+
+    bool planBatch(path_msgs::PlanPathBatch::Request& req, path_msgs::PlanPathBatch::Response& res);
+    path_msgs::PathSequence dispatchRequest(const path_msgs::PlanPathGoal &request);
+
+    void planningWorker();
+    path_msgs::PathSequence planThreaded(const path_msgs::PlanPathGoal &request, const CancellationToken::Ptr& token,
+                                         const ros::Time& search_deadline, bool preliminary);
 
-    void planThreaded(const path_msgs::PlanPathGoal &request);
-    path_msgs::PathSequence doPlan(const path_msgs::PlanPathGoal& request);
+    /**
+     * @brief doPlan runs a search on the worker thread and waits until it is done, preempted or the deadline has passed
+     * @param token cancels the search, all searches of a request share it
+     * @param search_deadline end of the search time of the request, see searchTimeLimit
+     * @param deadline the search is cancelled, if it is still running then
+     * @param preliminary runs planPreliminary instead of the final search
+     */
+    path_msgs::PathSequence doPlan(const path_msgs::PlanPathGoal& request, const CancellationToken::Ptr& token,
+                                   const ros::Time& search_deadline, const ros::Time& deadline, bool preliminary);
 
 
-    path_msgs::DirectionalPath smoothPathSegment(const path_msgs::DirectionalPath &path, double weight_data, double weight_smooth, double tolerance);
+    void smoothPathSegment(PathBuffer::Segment &path, double weight_data, double weight_smooth, double tolerance);
 
-    void subdividePath(path_msgs::DirectionalPath& result, geometry_msgs::PoseStamped low, geometry_msgs::PoseStamped up, double max_distance);
+    void subdividePath(PathBuffer::Segment& result,
+                       double low_x, double low_y, double low_theta,
+                       double up_x, double up_y, double up_theta,
+                       double max_distance);
 
 protected:
     ros::NodeHandle nh;
@@ -222,34 +344,77 @@ protected:
 
     actionlib::SimpleActionServer<path_msgs::PlanPathAction> server_;
 
+    // batches wait for running requests, so they are served by their own thread instead of the spin thread
+    ros::CallbackQueue batch_queue_;
+    std::unique_ptr<ros::AsyncSpinner> batch_spinner_;
+    ros::ServiceServer batch_server_;
+    std::size_t batch_threads_;
+    boost::mutex query_mutex_;
+
     ros::Publisher viz_pub;
     ros::Publisher viz_array_pub;
     ros::Publisher cost_pub;
     ros::Publisher map_pub;
     tf::TransformListener tfl;
 
+    PlannerDiagnostics diagnostics_;
+
     std::string world_frame_;
     std::string robot_frame_;
 
     lib_path::SimpleGridMap2d * map_info;
     double map_rotation_yaw_;
 
-    nav_msgs::OccupancyGridConstPtr pending_map;
+    // map versions
+    boost::mutex map_ingest_mutex_;
+    boost::mutex snapshot_mutex_;
+    MapSnapshot::ConstPtr map_snapshot_;
+
+    // snapshot that map_info has been built from, map_info is only used by the planning thread
+    MapSnapshot::ConstPtr active_snapshot_;
+    // cells [x0, x1) x [y0, y1) of map_info that sensor data or obstacle growing have written since the activation
+    int modified_x0_, modified_y0_, modified_x1_, modified_y1_;
+
+    ObstacleInflation obstacle_inflation_;
+
+    std::unique_ptr<HeuristicCache> heuristic_cache_;
+    std::vector<std::pair<double, double>> heuristic_cache_goals_;
 
     nav_msgs::OccupancyGrid cost_map;
-    std::vector<double> gradient_x;
-    std::vector<double> gradient_y;
+    std::size_t cost_map_revision_;
+    std::size_t published_cost_map_revision_;
+    CostGradient cost_gradient_;
 
-    sensor_msgs::PointCloud2 cloud_;
-    sensor_msgs::LaserScan scan_front;
-    sensor_msgs::LaserScan scan_back;
+    PathBuffer postprocess_buffer_;
+    PathBuffer::Segment interpolation_buffer_;
 
-    // threaded
-    path_msgs::PathSequence thread_result;
-    bool thread_running;
-    boost::thread* thread_;
-    boost::mutex thread_mutex;
+    // latest sensor messages, integrated when a request is planned
+    boost::mutex sensor_mutex_;
+    sensor_msgs::PointCloud2ConstPtr cloud_;
+    sensor_msgs::LaserScanConstPtr scan_front;
+    sensor_msgs::LaserScanConstPtr scan_back;
+    ScanTable scan_table_front_;
+    ScanTable scan_table_back_;
 
+    // threaded
+    boost::thread worker_thread_;
+    boost::mutex worker_mutex_;
+    boost::condition_variable worker_wakeup_;
+    boost::condition_variable worker_done_;
+    bool worker_shutdown_;
+    bool worker_has_job_;
+    bool worker_busy_;
+    path_msgs::PlanPathGoal worker_request_;
+    path_msgs::PathSequence worker_result_;
+    CancellationToken::Ptr worker_token_;
+    ros::Time worker_search_deadline_;
+    bool worker_preliminary_;
+
+    CancellationToken::Ptr planning_token_;
+    ros::Time search_deadline_;
+
+    // serializes whole requests (single requests and batches) from map preparation to post-processing
+    boost::mutex request_mutex_;
     boost::mutex map_mutex;
 
 protected:
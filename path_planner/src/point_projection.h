@@ -0,0 +1,84 @@
+#ifndef POINT_PROJECTION_H
+#define POINT_PROJECTION_H
+
+/// SYSTEM
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+
+namespace Utils_PointProjection
+{
+
+/**
+ * @brief The CellTransform struct maps sensor coordinates to fractional cell coordinates:
+ *        cx = xx * x + xy * y + xz * z + x0, cy = yx * x + yy * y + yz * z + y0
+ */
+struct CellTransform
+{
+    float xx, xy, xz, x0;
+    float yx, yy, yz, y0;
+};
+
+/**
+ * @brief cellBounds finds the cells [x0, x1) x [y0, y1) that markCells can hit with points inside the box [min, max],
+ *        clipped to the grid
+ */
+inline void cellBounds(const CellTransform& t, const float* min, const float* max, int width, int height,
+                       int& x0, int& y0, int& x1, int& y1)
+{
+    const float tx[3] = { t.xx, t.xy, t.xz };
+    const float ty[3] = { t.yx, t.yy, t.yz };
+
+    float lo_x = t.x0, hi_x = t.x0;
+    float lo_y = t.y0, hi_y = t.y0;
+    for(int i = 0; i < 3; ++i) {
+        lo_x += std::min(tx[i] * min[i], tx[i] * max[i]);
+        hi_x += std::max(tx[i] * min[i], tx[i] * max[i]);
+        lo_y += std::min(ty[i] * min[i], ty[i] * max[i]);
+        hi_y += std::max(ty[i] * min[i], ty[i] * max[i]);
+    }
+
+    // also catches NaN, e.g. from infinite coordinates
+    if(!(lo_x <= hi_x) || !(lo_y <= hi_y)) {
+        x0 = y0 = 0;
+        x1 = width;
+        y1 = height;
+        return;
+    }
+
+    // one cell of margin, the kernels may round differently
+    x0 = (int) std::max(0.f, std::min<float>(width, lo_x - 1.f));
+    y0 = (int) std::max(0.f, std::min<float>(height, lo_y - 1.f));
+    x1 = (int) std::max(0.f, std::min<float>(width, hi_x + 2.f));
+    y1 = (int) std::max(0.f, std::min<float>(height, hi_y + 2.f));
+}
+
+/**
+ * @brief Reference implementation of markCells, used for the remaining points of the SIMD versions
+ */
+inline void markCellsScalar(const CellTransform& t, const float* x, const float* y, const float* z, std::size_t n,
+                            uint8_t* grid, int width, int height, uint8_t value)
+{
+    for(std::size_t i = 0; i < n; ++i) {
+        float cx = t.xx * x[i] + t.xy * y[i] + t.xz * z[i] + t.x0;
+        float cy = t.yx * x[i] + t.yy * y[i] + t.yz * z[i] + t.y0;
+        // also rejects NaN
+        if(cx >= 0.f && cy >= 0.f && cx < width && cy < height) {
+            grid[(int) cy * width + (int) cx] = value;
+        }
+    }
+}
+
+}
+
+/**
+ * @brief Include SIMD functions depending on requested CPU architecture
+ */
+
+#if __SSE4_2__
+#include "point_projection_sse.h"
+#else
+#include "point_projection_nosimd.h"
+#endif
+
+#endif // POINT_PROJECTION_H
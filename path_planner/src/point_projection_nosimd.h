@@ -0,0 +1,22 @@
+#ifndef POINT_PROJECTION_NO_SIMD
+#define POINT_PROJECTION_NO_SIMD
+
+
+/**
+ * @brief Implementation of the point projection kernels without SIMD
+ */
+namespace Utils_PointProjection
+{
+
+/**
+ * @brief Set the cells hit by the points (x[i], y[i], z[i]) to value, points outside of the grid are ignored
+ */
+inline void markCells(const CellTransform& t, const float* x, const float* y, const float* z, std::size_t n,
+                      uint8_t* grid, int width, int height, uint8_t value)
+{
+    markCellsScalar(t, x, y, z, n, grid, width, height, value);
+}
+
+}
+
+#endif // POINT_PROJECTION_NO_SIMD
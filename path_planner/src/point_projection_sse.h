@@ -0,0 +1,68 @@
+#ifndef POINT_PROJECTION_SSE
+#define POINT_PROJECTION_SSE
+
+
+#include <nmmintrin.h>
+
+
+/**
+ * @brief SSE implementation of the point projection kernels
+ */
+namespace Utils_PointProjection
+{
+
+/**
+ * @brief Set the cells hit by the points (x[i], y[i], z[i]) to value, points outside of the grid are ignored
+ */
+inline void markCells(const CellTransform& t, const float* x, const float* y, const float* z, std::size_t n,
+                      uint8_t* grid, int width, int height, uint8_t value)
+{
+    const __m128 xx = _mm_set1_ps(t.xx), xy = _mm_set1_ps(t.xy), xz = _mm_set1_ps(t.xz), x0 = _mm_set1_ps(t.x0);
+    const __m128 yx = _mm_set1_ps(t.yx), yy = _mm_set1_ps(t.yy), yz = _mm_set1_ps(t.yz), y0 = _mm_set1_ps(t.y0);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 w = _mm_set1_ps(width);
+    const __m128 h = _mm_set1_ps(height);
+    const __m128i stride = _mm_set1_epi32(width);
+
+    std::size_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+        const __m128 px = _mm_loadu_ps(x + i);
+        const __m128 py = _mm_loadu_ps(y + i);
+        const __m128 pz = _mm_loadu_ps(z + i);
+
+        const __m128 cx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xx, px), _mm_mul_ps(xy, py)), _mm_add_ps(_mm_mul_ps(xz, pz), x0));
+        const __m128 cy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(yx, px), _mm_mul_ps(yy, py)), _mm_add_ps(_mm_mul_ps(yz, pz), y0));
+
+        // ordered comparisons are false for NaN
+        const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(cx, zero), _mm_cmplt_ps(cx, w)),
+                                         _mm_and_ps(_mm_cmpge_ps(cy, zero), _mm_cmplt_ps(cy, h)));
+        const int mask = _mm_movemask_ps(inside);
+        if(mask == 0) {
+            continue;
+        }
+
+        // truncation equals floor for non-negative coordinates
+        const __m128i idx = _mm_add_epi32(_mm_mullo_epi32(_mm_cvttps_epi32(cy), stride), _mm_cvttps_epi32(cx));
+        int cells[4];
+        _mm_storeu_si128((__m128i*) cells, idx);
+
+        if(mask == 0xF) {
+            grid[cells[0]] = value;
+            grid[cells[1]] = value;
+            grid[cells[2]] = value;
+            grid[cells[3]] = value;
+        } else {
+            for(int j = 0; j < 4; ++j) {
+                if(mask & (1 << j)) {
+                    grid[cells[j]] = value;
+                }
+            }
+        }
+    }
+
+    markCellsScalar(t, x + i, y + i, z + i, n - i, grid, width, height, value);
+}
+
+}
+
+#endif // POINT_PROJECTION_SSE
@@ -151,7 +151,7 @@ struct SBPLPathPlanner : public Planner
         boost::shared_ptr<SBPLPlanner> planner = initializePlanner(env, start_id, goal_id, initialEpsilon,
                                                                    bsearchuntilfirstsolution);
 
-        // plan
+        // plan, replan cannot be interrupted by a preemption, the time limit bounds the wait of the next request
         vector<int> solution_stateIDs;
         double allocated_time_secs = 10.0; // in seconds
         planner->replan(allocated_time_secs, &solution_stateIDs);
@@ -0,0 +1,157 @@
+#ifndef TILED_GRID_H
+#define TILED_GRID_H
+
+/// SYSTEM
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief The TiledGrid class is a row-major grid stored in square tiles.
+ *        Copies share their tiles with the original, a tile is only cloned when a copy writes to it.
+ *
+ * Published grids are immutable, so a tile can be shared by any number of map versions
+ * and threads, as long as only the grid that created or cloned it writes to it.
+ */
+template <typename T>
+class TiledGrid
+{
+public:
+    typedef std::shared_ptr<const TiledGrid> ConstPtr;
+
+    enum { TILE_SHIFT = 6, TILE_SIZE = 1 << TILE_SHIFT, TILE_MASK = TILE_SIZE - 1 };
+
+public:
+    TiledGrid(unsigned width, unsigned height)
+        : width_(width), height_(height),
+          tiles_x_((width + TILE_MASK) >> TILE_SHIFT), tiles_y_((height + TILE_MASK) >> TILE_SHIFT),
+          tiles_(tiles_x_ * tiles_y_), owned_(tiles_.size(), true)
+    {
+        for(std::shared_ptr<std::vector<T>>& tile : tiles_) {
+            tile.reset(new std::vector<T>(TILE_SIZE * TILE_SIZE));
+        }
+    }
+
+    /**
+     * @brief copy constructor, shares all tiles with other
+     */
+    TiledGrid(const TiledGrid& other)
+        : width_(other.width_), height_(other.height_),
+          tiles_x_(other.tiles_x_), tiles_y_(other.tiles_y_),
+          tiles_(other.tiles_), owned_(tiles_.size(), false)
+    {
+    }
+
+    TiledGrid& operator = (const TiledGrid&) = delete;
+
+    unsigned width() const
+    {
+        return width_;
+    }
+    unsigned height() const
+    {
+        return height_;
+    }
+    unsigned tilesX() const
+    {
+        return tiles_x_;
+    }
+    unsigned tilesY() const
+    {
+        return tiles_y_;
+    }
+
+    const T& at(unsigned x, unsigned y) const
+    {
+        return (*tiles_[(y >> TILE_SHIFT) * tiles_x_ + (x >> TILE_SHIFT)])[((y & TILE_MASK) << TILE_SHIFT) + (x & TILE_MASK)];
+    }
+
+    /**
+     * @brief sharesTile is true, iff both grids use the same buffer for the tile (tx, ty)
+     */
+    bool sharesTile(const TiledGrid& other, unsigned tx, unsigned ty) const
+    {
+        return tiles_x_ == other.tiles_x_ && tiles_y_ == other.tiles_y_ &&
+                tiles_[ty * tiles_x_ + tx] == other.tiles_[ty * tiles_x_ + tx];
+    }
+
+    /**
+     * @brief readTile calls fn(x, y, len, cells) for every row of the tile (tx, ty),
+     *        cells points to the cells [x, x + len) of row y
+     */
+    template <typename Fn>
+    void readTile(unsigned tx, unsigned ty, Fn fn) const
+    {
+        const T* cells = tiles_[ty * tiles_x_ + tx]->data();
+
+        unsigned x = tx << TILE_SHIFT;
+        unsigned y0 = ty << TILE_SHIFT;
+        unsigned len = std::min<unsigned>(TILE_SIZE, width_ - x);
+        unsigned y1 = std::min<unsigned>(y0 + TILE_SIZE, height_);
+        for(unsigned y = y0; y < y1; ++y, cells += TILE_SIZE) {
+            fn(x, y, len, cells);
+        }
+    }
+
+    /**
+     * @brief writeTile is readTile for writing, a shared tile is cloned first
+     */
+    template <typename Fn>
+    void writeTile(unsigned tx, unsigned ty, Fn fn)
+    {
+        std::size_t idx = ty * tiles_x_ + tx;
+        if(!owned_[idx]) {
+            tiles_[idx].reset(new std::vector<T>(*tiles_[idx]));
+            owned_[idx] = true;
+        }
+
+        T* cells = tiles_[idx]->data();
+
+        unsigned x = tx << TILE_SHIFT;
+        unsigned y0 = ty << TILE_SHIFT;
+        unsigned len = std::min<unsigned>(TILE_SIZE, width_ - x);
+        unsigned y1 = std::min<unsigned>(y0 + TILE_SIZE, height_);
+        for(unsigned y = y0; y < y1; ++y, cells += TILE_SIZE) {
+            fn(x, y, len, cells);
+        }
+    }
+
+    /**
+     * @brief copyTo copies the cells [x0, x1) x [y0, y1) into a row-major buffer with width() columns
+     */
+    void copyTo(T* dst, unsigned x0, unsigned y0, unsigned x1, unsigned y1) const
+    {
+        x1 = std::min(x1, width_);
+        y1 = std::min(y1, height_);
+        if(x0 >= x1 || y0 >= y1) {
+            return;
+        }
+
+        for(unsigned ty = y0 >> TILE_SHIFT, ey = (y1 - 1) >> TILE_SHIFT; ty <= ey; ++ty) {
+            for(unsigned tx = x0 >> TILE_SHIFT, ex = (x1 - 1) >> TILE_SHIFT; tx <= ex; ++tx) {
+                readTile(tx, ty, [&](unsigned x, unsigned y, unsigned len, const T* cells) {
+                    if(y < y0 || y >= y1) {
+                        return;
+                    }
+                    unsigned from = std::max(x, x0);
+                    unsigned to = std::min(x + len, x1);
+                    std::memcpy(dst + std::size_t(y) * width_ + from, cells + (from - x), (to - from) * sizeof(T));
+                });
+            }
+        }
+    }
+
+private:
+    unsigned width_;
+    unsigned height_;
+    unsigned tiles_x_;
+    unsigned tiles_y_;
+
+    std::vector<std::shared_ptr<std::vector<T>>> tiles_;
+    // tiles created or cloned by this grid, all others are shared and must not be written
+    std::vector<bool> owned_;
+};
+
+#endif // TILED_GRID_H
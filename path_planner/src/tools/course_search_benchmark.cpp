@@ -0,0 +1,171 @@
+/*
+ * Benchmark for the graph search of the course planner.
+ * Builds a synthetic grid of one-way roads and plans between random points on the course,
+ * once with the transition table and once with the graph search, and checks that both find the same paths.
+ * Needs a running roscore, since the course map and the search read parameters.
+ */
+
+/// COMPONENT
+#include "../course_planner/course/course_map.h"
+#include "../course_planner/course/search.h"
+
+/// SYSTEM
+#include <ros/ros.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+XmlRpc::XmlRpcValue point(double x, double y)
+{
+    XmlRpc::XmlRpcValue pt;
+    pt[0] = x;
+    pt[1] = y;
+    return pt;
+}
+
+XmlRpc::XmlRpcValue segment(double x0, double y0, double x1, double y1)
+{
+    XmlRpc::XmlRpcValue s;
+    s[0] = point(x0, y0);
+    s[1] = point(x1, y1);
+    return s;
+}
+
+/**
+ * @brief gridOfRoads generates n horizontal and n vertical roads with alternating directions
+ */
+XmlRpc::XmlRpcValue gridOfRoads(int n, double spacing)
+{
+    XmlRpc::XmlRpcValue segments;
+    segments.setSize(0);
+
+    double min = -spacing;
+    double max = n * spacing;
+
+    int index = 0;
+    for(int i = 0; i < n; ++i) {
+        double offset = i * spacing;
+        if(i % 2 == 0) {
+            segments[index++] = segment(min, offset, max, offset);
+            segments[index++] = segment(offset, max, offset, min);
+        } else {
+            segments[index++] = segment(max, offset, min, offset);
+            segments[index++] = segment(offset, min, offset, max);
+        }
+    }
+    return segments;
+}
+
+path_geom::PathPose randomPoseOn(const Segment& segment)
+{
+    Eigen::Vector2d start = segment.line.startPoint();
+    Eigen::Vector2d delta = segment.line.endPoint() - start;
+
+    // keep away from the ends of the segment
+    double f = 0.1 + 0.8 * (std::rand() / (double) RAND_MAX);
+    Eigen::Vector2d pt = start + f * delta;
+    return path_geom::PathPose(pt(0), pt(1), std::atan2(delta(1), delta(0)));
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    ros::init(argc, argv, "course_search_benchmark");
+    ros::NodeHandle nh;
+    ros::NodeHandle pnh("~");
+
+    // cached chains would hide the search that is measured
+    pnh.setParam("course/result_cache/size", 0);
+    // the table is compared with the graph search, it is only precomputed by default if it can be stored
+    pnh.setParam("course/precompute/enabled", true);
+
+    int roads = argc > 1 ? std::atoi(argv[1]) : 30;
+    int queries = argc > 2 ? std::atoi(argv[2]) : 100;
+
+    CourseMap course(nh);
+
+    auto load_start = std::chrono::high_resolution_clock::now();
+    course.load(gridOfRoads(roads, 10.0));
+    auto load_end = std::chrono::high_resolution_clock::now();
+
+    const std::vector<Segment>& segments = course.getSegments();
+    std::cout << "course: " << segments.size() << " segments, " << course.getTransitionCount() << " transitions, loaded in "
+              << std::chrono::duration<double, std::milli>(load_end - load_start).count() << "ms" << std::endl;
+
+    Search search(course);
+
+    auto table_start = std::chrono::high_resolution_clock::now();
+    search.loadTransitionTable();
+    auto table_end = std::chrono::high_resolution_clock::now();
+    std::cout << "transition table loaded in " << std::chrono::duration<double, std::milli>(table_end - table_start).count()
+              << "ms" << std::endl;
+
+    std::vector<std::pair<path_geom::PathPose, path_geom::PathPose>> poses;
+    for(int i = 0; i < queries; ++i) {
+        path_geom::PathPose start = randomPoseOn(segments[std::rand() % segments.size()]);
+        path_geom::PathPose end = randomPoseOn(segments[std::rand() % segments.size()]);
+        poses.emplace_back(start, end);
+    }
+
+    std::vector<ResultCache::Chain> table_chains(queries);
+    std::vector<double> table_costs(queries);
+    int mismatches = 0;
+    int ties = 0;
+
+    for(int table = 1; table >= 0; --table) {
+        if(!table) {
+            search.setTransitionTable(nullptr);
+        }
+
+        course.resetClosestSegmentStatistics();
+
+        int found = 0;
+        double total_ms = 0.0;
+        double max_ms = 0.0;
+        for(int i = 0; i < queries; ++i) {
+            const auto& query = poses[i];
+            auto query_start = std::chrono::high_resolution_clock::now();
+            path_msgs::PathSequence path = search.findCoursePath(query.first, query.second);
+            auto query_end = std::chrono::high_resolution_clock::now();
+
+            double ms = std::chrono::duration<double, std::milli>(query_end - query_start).count();
+            total_ms += ms;
+            max_ms = std::max(max_ms, ms);
+            if(!path.paths.empty()) {
+                ++found;
+            }
+
+            if(table) {
+                table_chains[i] = search.lastChain();
+                table_costs[i] = search.lastCost();
+                continue;
+            }
+
+            // both modes have to agree, only equally cheap chains may differ
+            double cost = search.lastCost();
+            bool same_cost = cost == table_costs[i] || std::abs(cost - table_costs[i]) <= 1e-6 * std::max(1.0, std::abs(cost));
+            if(!same_cost) {
+                ++mismatches;
+                std::cerr << "query " << i << ": graph search cost " << cost << ", table lookup cost " << table_costs[i] << std::endl;
+            } else if(search.lastChain() != table_chains[i]) {
+                ++ties;
+            }
+        }
+
+        std::cout << (table ? "table lookup: " : "graph search: ") << queries << " queries, " << found << " paths found\n"
+                  << "  mean " << total_ms / queries << "ms, max " << max_ms << "ms" << std::endl;
+
+        CourseMap::QueryStatistics stats = course.getClosestSegmentStatistics();
+        std::cout << "  " << stats.queries << " closest segment queries in " << stats.seconds * 1e3 << "ms" << std::endl;
+    }
+
+    std::cout << "comparison: " << mismatches << " queries with different costs, "
+              << ties << " queries with different chains of the same cost" << std::endl;
+
+    return mismatches == 0 ? 0 : 1;
+}
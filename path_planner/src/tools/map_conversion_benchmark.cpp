@@ -0,0 +1,116 @@
+/*
+ * Micro benchmark for the map ingest kernels in map_conversion.h.
+ * Compares the SIMD kernels against the per-cell loops used by Planner::updateMap
+ * and Planner::preprocess before.
+ */
+
+/// COMPONENT
+#include "../map_conversion.h"
+
+/// SYSTEM
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+const uint8_t FREE_THRESHOLD = 50;
+
+struct Grid
+{
+    Grid(unsigned w, unsigned h)
+        : w(w), h(h), data(w*h)
+    {}
+
+    bool isFree(unsigned x, unsigned y) const
+    {
+        return data[y * w + x] <= FREE_THRESHOLD;
+    }
+
+    unsigned w;
+    unsigned h;
+    std::vector<uint8_t> data;
+};
+
+void occupancyLoop(const std::vector<int8_t>& map, std::vector<uint8_t>& data)
+{
+    int i = 0;
+    for(std::vector<int8_t>::const_iterator it = map.begin(); it != map.end(); ++it) {
+        data[i++] = std::min(100, *it + 1);
+    }
+}
+
+void visualizationLoop(const Grid& grid, std::vector<int8_t>& viz)
+{
+    int8_t* data = viz.data();
+    for(int y = 0, h = grid.h; y < h; ++y) {
+        for(int x = 0, w = grid.w; x < w; ++x, ++data) {
+            *data = grid.isFree(x,y) ? 255 : 0;
+        }
+    }
+}
+
+template <typename Fn>
+double measure(Fn fn, int repetitions)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < repetitions; ++i) {
+        fn();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    int repetitions = argc > 1 ? std::atoi(argv[1]) : 10;
+
+#if defined(USE_AVX2) && defined(__AVX2__)
+    std::cout << "kernels: AVX2" << std::endl;
+#elif __SSE4_2__
+    std::cout << "kernels: SSE4.2" << std::endl;
+#else
+    std::cout << "kernels: no SIMD" << std::endl;
+#endif
+
+    for(unsigned size : {1000u, 4000u, 8000u}) {
+        std::size_t n = std::size_t(size) * size;
+
+        std::vector<int8_t> map(n);
+        for(std::size_t i = 0; i < n; ++i) {
+            map[i] = (std::rand() % 102) - 1;
+        }
+
+        Grid grid(size, size);
+        std::vector<uint8_t> reference(n);
+        std::vector<int8_t> viz(n);
+        std::vector<int8_t> viz_reference(n);
+
+        double t_occ_loop = measure([&]() { occupancyLoop(map, reference); }, repetitions);
+        double t_occ_kernel = measure([&]() { Utils_MapConversion::occupancyToGrid(map.data(), grid.data.data(), n); }, repetitions);
+        double t_cost_kernel = measure([&]() { Utils_MapConversion::costToGrid(map.data(), grid.data.data(), n); }, repetitions);
+
+        Utils_MapConversion::occupancyToGrid(map.data(), grid.data.data(), n);
+        bool occ_equal = grid.data == reference;
+
+        double t_viz_loop = measure([&]() { visualizationLoop(grid, viz_reference); }, repetitions);
+        double t_viz_kernel = measure([&]() { Utils_MapConversion::gridToVisualization(grid.data.data(), viz.data(), n, FREE_THRESHOLD); }, repetitions);
+        bool viz_equal = viz == viz_reference;
+
+        std::cout << size << "x" << size << ":\n"
+                  << "  occupancy -> grid:     loop " << t_occ_loop << "ms, kernel " << t_occ_kernel << "ms"
+                  << (occ_equal ? "" : " (MISMATCH)") << "\n"
+                  << "  cost map -> grid:      kernel " << t_cost_kernel << "ms\n"
+                  << "  grid -> visualization: loop " << t_viz_loop << "ms, kernel " << t_viz_kernel << "ms"
+                  << (viz_equal ? "" : " (MISMATCH)") << std::endl;
+
+        if(!occ_equal || !viz_equal) {
+            return 1;
+        }
+    }
+
+    return 0;
+}